@@ -0,0 +1,79 @@
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "bench_common.h"
+#include "boundeddequeofunique.h"
+#include "dequeofunique.h"
+
+using containerofunique::bounded_deque_of_unique;
+using containerofunique::deque_of_unique;
+using containerofunique::flat_index;
+using containerofunique::lru_eviction;
+
+// "Recently seen IDs" window: a stream of 1M IDs, a window of n, and dup%
+// of the stream repeating an earlier ID.
+constexpr std::int64_t stream_size = 1 << 20;
+
+template <class C>
+void bm_manual_window(benchmark::State& state) {
+  auto input = bench::make_input<int>(stream_size, state.range(1));
+  auto window = static_cast<std::size_t>(state.range(0));
+  for (auto _ : state) {
+    C c;
+    for (int v : input) {
+      if (c.push_back(v) && c.size() > window) {
+        c.pop_front();
+      }
+    }
+    benchmark::DoNotOptimize(c);
+  }
+  state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) *
+                          stream_size);
+}
+
+template <class C>
+void bm_bounded_window(benchmark::State& state) {
+  auto input = bench::make_input<int>(stream_size, state.range(1));
+  for (auto _ : state) {
+    C c(static_cast<std::size_t>(state.range(0)));
+    for (int v : input) {
+      c.push_back(v);
+    }
+    benchmark::DoNotOptimize(c);
+  }
+  state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) *
+                          stream_size);
+}
+
+void apply_windows(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"window", "dup%"});
+  for (std::int64_t window : {256, 4096, 65536}) {
+    for (std::int64_t dup : {0, 50, 90}) {
+      b->Args({window, dup});
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  using flat_deque =
+      deque_of_unique<int, std::hash<int>, std::equal_to<int>,
+                      std::allocator<int>, flat_index>;
+
+  benchmark::RegisterBenchmark("deque_of_unique<int>/manual_window",
+                               bm_manual_window<deque_of_unique<int>>)
+      ->Apply(apply_windows);
+  benchmark::RegisterBenchmark("flat_deque_of_unique<int>/manual_window",
+                               bm_manual_window<flat_deque>)
+      ->Apply(apply_windows);
+  benchmark::RegisterBenchmark("bounded_deque_of_unique<int>/fifo_window",
+                               bm_bounded_window<bounded_deque_of_unique<int>>)
+      ->Apply(apply_windows);
+  benchmark::RegisterBenchmark(
+      "bounded_deque_of_unique<int>/lru_window",
+      bm_bounded_window<bounded_deque_of_unique<int, lru_eviction>>)
+      ->Apply(apply_windows);
+
+  return bench::run(argc, argv);
+}
@@ -0,0 +1,376 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// Shared payloads, inputs and benchmark bodies for the container benchmarks.
+// Every benchmark takes two arguments: the number of input elements and the
+// percentage of those elements that duplicate an earlier one.
+namespace bench {
+
+// 256-byte element whose identity is its first word.
+struct LargeStruct {
+  std::array<std::uint64_t, 32> data{};
+
+  bool operator==(const LargeStruct& other) const {
+    return data[0] == other.data[0];
+  }
+};
+
+struct LargeStructHash {
+  std::size_t operator()(const LargeStruct& s) const {
+    return std::hash<std::uint64_t>{}(s.data[0]);
+  }
+};
+
+template <class T>
+struct payload;
+
+template <>
+struct payload<int> {
+  static constexpr std::int64_t max_size = 10'000'000;
+  static int make(std::uint64_t id) { return static_cast<int>(id); }
+};
+
+template <>
+struct payload<std::string> {
+  static constexpr std::int64_t max_size = 10'000'000;
+  // 32 characters, long enough to defeat the small string optimisation.
+  static std::string make(std::uint64_t id) {
+    std::string s = std::to_string(id);
+    s.insert(0, 32 - s.size(), 'k');
+    return s;
+  }
+};
+
+template <>
+struct payload<LargeStruct> {
+  // 10M 256-byte elements would need several GB per container.
+  static constexpr std::int64_t max_size = 1 << 20;
+  static LargeStruct make(std::uint64_t id) {
+    LargeStruct s;
+    s.data.fill(id);
+    return s;
+  }
+};
+
+// n elements, dup_percent of which repeat an earlier element, shuffled with
+// a fixed seed so runs are comparable.
+template <class T>
+std::vector<T> make_input(std::int64_t n, std::int64_t dup_percent) {
+  auto unique = std::max<std::int64_t>(1, n - n * dup_percent / 100);
+  std::mt19937_64 rng(42);
+  std::vector<std::uint64_t> ids;
+  ids.reserve(static_cast<std::size_t>(n));
+  for (std::int64_t i = 0; i < n; ++i) {
+    ids.push_back(static_cast<std::uint64_t>(i < unique ? i : rng() % unique));
+  }
+  std::shuffle(ids.begin(), ids.end(), rng);
+  std::vector<T> input;
+  input.reserve(ids.size());
+  for (auto id : ids) {
+    input.push_back(payload<T>::make(id));
+  }
+  return input;
+}
+
+// Keys guaranteed to be absent from make_input(n, ...).
+template <class T>
+std::vector<T> make_missing(std::int64_t n) {
+  std::vector<T> keys;
+  keys.reserve(static_cast<std::size_t>(n));
+  for (std::int64_t i = 0; i < n; ++i) {
+    keys.push_back(payload<T>::make(static_cast<std::uint64_t>(n + i)));
+  }
+  return keys;
+}
+
+template <class T>
+void apply_sizes(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"n", "dup%"});
+  for (std::int64_t n : {16, 256, 4096, 65536, 1 << 20, 10'000'000}) {
+    if (n > payload<T>::max_size) {
+      continue;
+    }
+    for (std::int64_t dup : {0, 50, 90}) {
+      b->Args({n, dup});
+    }
+  }
+}
+
+inline void set_items(benchmark::State& state) {
+  state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) *
+                          state.range(0));
+}
+
+template <class C>
+void bm_push_back(benchmark::State& state) {
+  auto input = make_input<typename C::value_type>(state.range(0),
+                                                  state.range(1));
+  for (auto _ : state) {
+    C c;
+    for (const auto& v : input) {
+      c.push_back(v);
+    }
+    benchmark::DoNotOptimize(c);
+  }
+  set_items(state);
+}
+
+template <class C>
+void bm_range_construct(benchmark::State& state) {
+  auto input = make_input<typename C::value_type>(state.range(0),
+                                                  state.range(1));
+  for (auto _ : state) {
+    C c(input.begin(), input.end());
+    benchmark::DoNotOptimize(c);
+  }
+  set_items(state);
+}
+
+template <class C>
+void bm_append_bulk(benchmark::State& state) {
+  auto input = make_input<typename C::value_type>(state.range(0),
+                                                  state.range(1));
+  for (auto _ : state) {
+    C c;
+    benchmark::DoNotOptimize(c.append_bulk(input.begin(), input.end()));
+  }
+  set_items(state);
+}
+
+// Splices the input into a container in batches of eight, the way a
+// caller merging many small batches would.
+template <class C>
+void bm_insert_batches(benchmark::State& state) {
+  auto input = make_input<typename C::value_type>(state.range(0),
+                                                  state.range(1));
+  for (auto _ : state) {
+    C c;
+    for (std::size_t i = 0; i < input.size(); i += 8) {
+      auto last = input.begin() + static_cast<std::ptrdiff_t>(
+                                      std::min(i + 8, input.size()));
+      c.insert(c.cend(), input.begin() + static_cast<std::ptrdiff_t>(i), last);
+    }
+    benchmark::DoNotOptimize(c);
+  }
+  set_items(state);
+}
+
+template <class C>
+void bm_copy(benchmark::State& state) {
+  auto input = make_input<typename C::value_type>(state.range(0),
+                                                  state.range(1));
+  const C source(input.begin(), input.end());
+  for (auto _ : state) {
+    // NOLINTNEXTLINE(performance-unnecessary-copy-initialization)
+    C c(source);
+    benchmark::DoNotOptimize(c);
+  }
+  set_items(state);
+}
+
+template <class C>
+void bm_find_hit(benchmark::State& state) {
+  auto input = make_input<typename C::value_type>(state.range(0),
+                                                  state.range(1));
+  const C c(input.begin(), input.end());
+  for (auto _ : state) {
+    for (const auto& v : input) {
+      benchmark::DoNotOptimize(c.find(v));
+    }
+  }
+  set_items(state);
+}
+
+template <class C>
+void bm_find_miss(benchmark::State& state) {
+  auto input = make_input<typename C::value_type>(state.range(0),
+                                                  state.range(1));
+  auto missing = make_missing<typename C::value_type>(state.range(0));
+  const C c(input.begin(), input.end());
+  for (auto _ : state) {
+    for (const auto& v : missing) {
+      benchmark::DoNotOptimize(c.find(v));
+    }
+  }
+  set_items(state);
+}
+
+// Looks keys up with contains_batch, 1024 at a time, for comparison with
+// the per-key loops of bm_find_hit and bm_find_miss.
+template <class C>
+void bm_contains_batch(benchmark::State& state, bool hit) {
+  constexpr std::size_t batch = 1024;
+  auto input = make_input<typename C::value_type>(state.range(0),
+                                                  state.range(1));
+  auto keys =
+      hit ? input : make_missing<typename C::value_type>(state.range(0));
+  const C c(input.begin(), input.end());
+  std::vector<std::uint64_t> bits(batch / 64);
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < keys.size(); i += batch) {
+      auto end = std::min(keys.size(), i + batch);
+      c.contains_batch(keys.begin() + static_cast<std::ptrdiff_t>(i),
+                       keys.begin() + static_cast<std::ptrdiff_t>(end),
+                       bits.data());
+      benchmark::DoNotOptimize(bits.data());
+    }
+  }
+  set_items(state);
+}
+
+// Erases 64 elements from random positions by value and puts them back at
+// the end, so the container size stays constant across iterations.
+template <class C>
+void bm_erase_value(benchmark::State& state) {
+  auto input = make_input<typename C::value_type>(state.range(0),
+                                                  state.range(1));
+  C c(input.begin(), input.end());
+  std::mt19937_64 rng(7);
+  std::vector<typename C::value_type> keys;
+  for (int i = 0; i < 64; ++i) {
+    keys.push_back(c[static_cast<std::size_t>(rng() % c.size())]);
+  }
+  for (auto _ : state) {
+    for (const auto& k : keys) {
+      erase(c, k);
+      c.push_back(k);
+    }
+  }
+  state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) *
+                          static_cast<std::int64_t>(keys.size()));
+}
+
+// Removes roughly 30% of the elements with erase_if.
+template <class C>
+void bm_erase_if(benchmark::State& state) {
+  auto input = make_input<typename C::value_type>(state.range(0),
+                                                  state.range(1));
+  const C source(input.begin(), input.end());
+  typename C::hasher hash;
+  for (auto _ : state) {
+    state.PauseTiming();
+    C c(source);
+    state.ResumeTiming();
+    benchmark::DoNotOptimize(erase_if(
+        c, [&hash](const typename C::value_type& v) {
+          return hash(v) % 10 < 3;
+        }));
+  }
+  set_items(state);
+}
+
+// Baseline: a raw sequence plus a std::unordered_set copy of every element,
+// the layout the containers replace.
+template <class Seq, class Hash>
+struct raw_unique {
+  using value_type = typename Seq::value_type;
+  using hasher = Hash;
+
+  Seq seq;
+  std::unordered_set<value_type, Hash> set;
+
+  bool push_back(const value_type& v) {
+    if (set.insert(v).second) {
+      seq.push_back(v);
+      return true;
+    }
+    return false;
+  }
+};
+
+template <class R>
+void bm_raw_push_back(benchmark::State& state) {
+  auto input = make_input<typename R::value_type>(state.range(0),
+                                                  state.range(1));
+  for (auto _ : state) {
+    R r;
+    for (const auto& v : input) {
+      r.push_back(v);
+    }
+    benchmark::DoNotOptimize(r);
+  }
+  set_items(state);
+}
+
+template <class R>
+void bm_raw_find_hit(benchmark::State& state) {
+  auto input = make_input<typename R::value_type>(state.range(0),
+                                                  state.range(1));
+  R r;
+  for (const auto& v : input) {
+    r.push_back(v);
+  }
+  for (auto _ : state) {
+    for (const auto& v : input) {
+      benchmark::DoNotOptimize(r.set.find(v));
+    }
+  }
+  set_items(state);
+}
+
+template <class C>
+void register_container(const std::string& name) {
+  using T = typename C::value_type;
+  benchmark::RegisterBenchmark((name + "/push_back").c_str(), bm_push_back<C>)
+      ->Apply(apply_sizes<T>);
+  benchmark::RegisterBenchmark((name + "/range_construct").c_str(),
+                               bm_range_construct<C>)
+      ->Apply(apply_sizes<T>);
+  benchmark::RegisterBenchmark((name + "/append_bulk").c_str(),
+                               bm_append_bulk<C>)
+      ->Apply(apply_sizes<T>);
+  benchmark::RegisterBenchmark((name + "/insert_batches").c_str(),
+                               bm_insert_batches<C>)
+      ->Apply(apply_sizes<T>);
+  benchmark::RegisterBenchmark((name + "/copy").c_str(), bm_copy<C>)
+      ->Apply(apply_sizes<T>);
+  benchmark::RegisterBenchmark((name + "/find_hit").c_str(), bm_find_hit<C>)
+      ->Apply(apply_sizes<T>);
+  benchmark::RegisterBenchmark((name + "/find_miss").c_str(), bm_find_miss<C>)
+      ->Apply(apply_sizes<T>);
+  benchmark::RegisterBenchmark((name + "/contains_batch_hit").c_str(),
+                               bm_contains_batch<C>, true)
+      ->Apply(apply_sizes<T>);
+  benchmark::RegisterBenchmark((name + "/contains_batch_miss").c_str(),
+                               bm_contains_batch<C>, false)
+      ->Apply(apply_sizes<T>);
+  benchmark::RegisterBenchmark((name + "/erase_value").c_str(),
+                               bm_erase_value<C>)
+      ->Apply(apply_sizes<T>);
+  benchmark::RegisterBenchmark((name + "/erase_if").c_str(), bm_erase_if<C>)
+      ->Apply(apply_sizes<T>);
+}
+
+template <class R>
+void register_baseline(const std::string& name) {
+  using T = typename R::value_type;
+  benchmark::RegisterBenchmark((name + "/push_back").c_str(),
+                               bm_raw_push_back<R>)
+      ->Apply(apply_sizes<T>);
+  benchmark::RegisterBenchmark((name + "/find_hit").c_str(), bm_raw_find_hit<R>)
+      ->Apply(apply_sizes<T>);
+}
+
+inline int run(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
+
+}  // namespace bench
@@ -0,0 +1,83 @@
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+#include "bench_common.h"
+#include "concurrentdedupqueue.h"
+
+using containerofunique::concurrent_dedup_queue;
+
+// Work-queue throughput: the given number of producers and as many
+// consumers move 1M task IDs, dup% of which repeat an earlier ID, through
+// one queue. Consumers pop one item at a time or in batches of 64. The
+// one_shard variant puts every item behind a single mutex, for comparison
+// with the default shard count.
+constexpr std::int64_t task_count = 1 << 20;
+
+template <std::size_t Batch, bool OneShard = false>
+void bm_work_queue(benchmark::State& state) {
+  auto input = bench::make_input<int>(task_count, state.range(1));
+  auto threads = static_cast<std::size_t>(state.range(0));
+  auto chunk = input.size() / threads;
+  auto shards = OneShard
+                    ? std::size_t{1}
+                    : concurrent_dedup_queue<int>::default_shard_count();
+  for (auto _ : state) {
+    concurrent_dedup_queue<int> q(shards);
+    std::vector<std::thread> consumers;
+    for (std::size_t t = 0; t < threads; ++t) {
+      consumers.emplace_back([&q] {
+        std::vector<int> batch;
+        batch.reserve(Batch);
+        while (q.pop_n(std::back_inserter(batch), Batch) != 0) {
+          benchmark::DoNotOptimize(batch.data());
+          batch.clear();
+        }
+      });
+    }
+    std::vector<std::thread> producers;
+    for (std::size_t t = 0; t < threads; ++t) {
+      auto first = input.begin() + static_cast<std::ptrdiff_t>(t * chunk);
+      auto last = t + 1 == threads ? input.end() : first + chunk;
+      producers.emplace_back([&q, first, last] {
+        for (auto it = first; it != last; ++it) {
+          q.push(*it);
+        }
+      });
+    }
+    for (auto& p : producers) {
+      p.join();
+    }
+    q.close();
+    for (auto& c : consumers) {
+      c.join();
+    }
+  }
+  state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) *
+                          task_count);
+}
+
+void apply_threads(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"threads", "dup%"})->UseRealTime();
+  for (std::int64_t threads : {1, 2, 4, 8}) {
+    for (std::int64_t dup : {0, 50}) {
+      b->Args({threads, dup});
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  benchmark::RegisterBenchmark("concurrent_dedup_queue<int>/pop",
+                               bm_work_queue<1>)
+      ->Apply(apply_threads);
+  benchmark::RegisterBenchmark("concurrent_dedup_queue<int>/pop_n_64",
+                               bm_work_queue<64>)
+      ->Apply(apply_threads);
+  benchmark::RegisterBenchmark("concurrent_dedup_queue<int>/pop_n_64/one_shard",
+                               bm_work_queue<64, true>)
+      ->Apply(apply_threads);
+
+  return bench::run(argc, argv);
+}
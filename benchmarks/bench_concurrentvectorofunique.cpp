@@ -0,0 +1,88 @@
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench_common.h"
+#include "concurrentvectorofunique.h"
+#include "vectorofunique.h"
+
+using containerofunique::concurrent_vector_of_unique;
+using containerofunique::vector_of_unique;
+
+// Multi-threaded ingestion: 1M elements, dup% of them repeating an earlier
+// one, split evenly between the given number of threads, all pushing into
+// one shared container.
+constexpr std::int64_t ingest_size = 1 << 20;
+
+// The pattern concurrent_vector_of_unique replaces: one global mutex.
+template <class T>
+class locked_vector_of_unique {
+ public:
+  bool push_back(const T& value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return v_.push_back(value);
+  }
+
+ private:
+  std::mutex mutex_;
+  vector_of_unique<T> v_;
+};
+
+template <class C, class T>
+void bm_ingest(benchmark::State& state) {
+  auto input = bench::make_input<T>(ingest_size, state.range(1));
+  auto threads = static_cast<std::size_t>(state.range(0));
+  auto chunk = input.size() / threads;
+  for (auto _ : state) {
+    C c;
+    std::vector<std::thread> workers;
+    for (std::size_t t = 0; t < threads; ++t) {
+      auto first = input.begin() + static_cast<std::ptrdiff_t>(t * chunk);
+      auto last = t + 1 == threads ? input.end() : first + chunk;
+      workers.emplace_back([&c, first, last] {
+        for (auto it = first; it != last; ++it) {
+          c.push_back(*it);
+        }
+      });
+    }
+    for (auto& w : workers) {
+      w.join();
+    }
+    benchmark::DoNotOptimize(c);
+  }
+  state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) *
+                          ingest_size);
+}
+
+void apply_threads(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"threads", "dup%"})->UseRealTime();
+  for (std::int64_t threads : {1, 2, 4, 8, 16}) {
+    for (std::int64_t dup : {0, 50}) {
+      b->Args({threads, dup});
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  benchmark::RegisterBenchmark(
+      "locked_vector_of_unique<int>/ingest",
+      bm_ingest<locked_vector_of_unique<int>, int>)
+      ->Apply(apply_threads);
+  benchmark::RegisterBenchmark(
+      "concurrent_vector_of_unique<int>/ingest",
+      bm_ingest<concurrent_vector_of_unique<int>, int>)
+      ->Apply(apply_threads);
+  benchmark::RegisterBenchmark(
+      "locked_vector_of_unique<std::string>/ingest",
+      bm_ingest<locked_vector_of_unique<std::string>, std::string>)
+      ->Apply(apply_threads);
+  benchmark::RegisterBenchmark(
+      "concurrent_vector_of_unique<std::string>/ingest",
+      bm_ingest<concurrent_vector_of_unique<std::string>, std::string>)
+      ->Apply(apply_threads);
+
+  return bench::run(argc, argv);
+}
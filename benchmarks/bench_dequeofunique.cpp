@@ -0,0 +1,52 @@
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "bench_common.h"
+#include "dequeofunique.h"
+
+using containerofunique::bloom_filter;
+using containerofunique::flat_index;
+using containerofunique::deque_of_unique;
+
+template <class T, class Hash = std::hash<T>>
+using flat_deque_of_unique =
+    deque_of_unique<T, Hash, std::equal_to<T>, std::allocator<T>, flat_index>;
+
+template <class T, class Hash = std::hash<T>>
+using bloom_deque_of_unique =
+    deque_of_unique<T, Hash, std::equal_to<T>, std::allocator<T>,
+                    bloom_filter<>>;
+
+int main(int argc, char** argv) {
+  using bench::LargeStruct;
+  using bench::LargeStructHash;
+
+  bench::register_container<deque_of_unique<int>>("deque_of_unique<int>");
+  bench::register_container<deque_of_unique<std::string>>(
+      "deque_of_unique<string>");
+  bench::register_container<deque_of_unique<LargeStruct, LargeStructHash>>(
+      "deque_of_unique<LargeStruct>");
+  bench::register_container<flat_deque_of_unique<int>>(
+      "flat_deque_of_unique<int>");
+  bench::register_container<flat_deque_of_unique<std::string>>(
+      "flat_deque_of_unique<string>");
+  bench::register_container<flat_deque_of_unique<LargeStruct, LargeStructHash>>(
+      "flat_deque_of_unique<LargeStruct>");
+  bench::register_container<bloom_deque_of_unique<int>>(
+      "bloom_deque_of_unique<int>");
+  bench::register_container<bloom_deque_of_unique<std::string>>(
+      "bloom_deque_of_unique<string>");
+
+  bench::register_baseline<
+      bench::raw_unique<std::deque<int>, std::hash<int>>>("raw_deque<int>");
+  bench::register_baseline<
+      bench::raw_unique<std::deque<std::string>, std::hash<std::string>>>(
+      "raw_deque<string>");
+  bench::register_baseline<
+      bench::raw_unique<std::deque<LargeStruct>, LargeStructHash>>(
+      "raw_deque<LargeStruct>");
+
+  return bench::run(argc, argv);
+}
@@ -0,0 +1,68 @@
+#include <cstdint>
+#include <string>
+
+#include "bench_common.h"
+#include "parallelbuild.h"
+#include "vectorofunique.h"
+
+using containerofunique::parallel_build;
+using containerofunique::vector_of_unique;
+
+// Building from 10M elements, dup% of them repeating an earlier one: the
+// sequential range constructor against parallel_build on 1 to 16 threads.
+constexpr std::int64_t build_size = 10'000'000;
+
+template <class T>
+void bm_range_constructor(benchmark::State& state) {
+  auto input = bench::make_input<T>(build_size, state.range(0));
+  for (auto _ : state) {
+    vector_of_unique<T> v(input.begin(), input.end());
+    benchmark::DoNotOptimize(v);
+  }
+  state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) *
+                          build_size);
+}
+
+template <class T>
+void bm_parallel_build(benchmark::State& state) {
+  auto input = bench::make_input<T>(build_size, state.range(1));
+  auto threads = static_cast<std::size_t>(state.range(0));
+  for (auto _ : state) {
+    auto v = parallel_build<vector_of_unique<T>>(input.begin(), input.end(),
+                                                 threads);
+    benchmark::DoNotOptimize(v);
+  }
+  state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) *
+                          build_size);
+}
+
+void apply_dups(benchmark::internal::Benchmark* b) {
+  b->ArgName("dup%")->Arg(0)->Arg(50)->Arg(90)->UseRealTime();
+}
+
+void apply_threads(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"threads", "dup%"})->UseRealTime();
+  for (std::int64_t threads : {1, 2, 4, 8, 16}) {
+    for (std::int64_t dup : {0, 50, 90}) {
+      b->Args({threads, dup});
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  benchmark::RegisterBenchmark("vector_of_unique<int>/range_constructor",
+                               bm_range_constructor<int>)
+      ->Apply(apply_dups);
+  benchmark::RegisterBenchmark("vector_of_unique<int>/parallel_build",
+                               bm_parallel_build<int>)
+      ->Apply(apply_threads);
+  benchmark::RegisterBenchmark(
+      "vector_of_unique<std::string>/range_constructor",
+      bm_range_constructor<std::string>)
+      ->Apply(apply_dups);
+  benchmark::RegisterBenchmark("vector_of_unique<std::string>/parallel_build",
+                               bm_parallel_build<std::string>)
+      ->Apply(apply_threads);
+
+  return bench::run(argc, argv);
+}
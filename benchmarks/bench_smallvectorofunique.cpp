@@ -0,0 +1,73 @@
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "bench_common.h"
+#include "smallvectorofunique.h"
+#include "vectorofunique.h"
+
+using containerofunique::flat_index;
+using containerofunique::small_vector_of_unique;
+using containerofunique::vector_of_unique;
+
+// Many short-lived small sets, like per-request tag lists: each iteration
+// builds 1024 containers from the same n elements, dup% of which repeat an
+// earlier one, and looks every element up once.
+constexpr std::int64_t sets_per_iteration = 1024;
+
+template <class C>
+void bm_small_sets(benchmark::State& state) {
+  auto input = bench::make_input<typename C::value_type>(state.range(0),
+                                                         state.range(1));
+  for (auto _ : state) {
+    for (std::int64_t s = 0; s < sets_per_iteration; ++s) {
+      C c;
+      for (const auto& v : input) {
+        c.push_back(v);
+      }
+      for (const auto& v : input) {
+        benchmark::DoNotOptimize(c.find(v));
+      }
+      benchmark::DoNotOptimize(c);
+    }
+  }
+  state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) *
+                          sets_per_iteration * state.range(0));
+}
+
+void apply_small_sizes(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"n", "dup%"});
+  for (std::int64_t n : {4, 8, 16, 32}) {
+    for (std::int64_t dup : {0, 50}) {
+      b->Args({n, dup});
+    }
+  }
+}
+
+template <class T>
+using flat_vector_of_unique =
+    vector_of_unique<T, std::hash<T>, std::equal_to<T>, std::allocator<T>,
+                     flat_index>;
+
+template <class T>
+void register_small_sets(const std::string& type) {
+  benchmark::RegisterBenchmark(("vector_of_unique<" + type + ">/small_sets")
+                                   .c_str(),
+                               bm_small_sets<vector_of_unique<T>>)
+      ->Apply(apply_small_sizes);
+  benchmark::RegisterBenchmark(
+      ("flat_vector_of_unique<" + type + ">/small_sets").c_str(),
+      bm_small_sets<flat_vector_of_unique<T>>)
+      ->Apply(apply_small_sizes);
+  benchmark::RegisterBenchmark(
+      ("small_vector_of_unique<" + type + ",16>/small_sets").c_str(),
+      bm_small_sets<small_vector_of_unique<T, 16>>)
+      ->Apply(apply_small_sizes);
+}
+
+int main(int argc, char** argv) {
+  register_small_sets<int>("int");
+  register_small_sets<std::string>("string");
+  return bench::run(argc, argv);
+}
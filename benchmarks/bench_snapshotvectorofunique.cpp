@@ -0,0 +1,96 @@
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "bench_common.h"
+#include "snapshotvectorofunique.h"
+#include "vectorofunique.h"
+
+using containerofunique::snapshot_vector_of_unique;
+using containerofunique::vector_of_unique;
+
+// Read-heavy lookups: the given number of threads each run 1M index_of
+// calls, half of them hits, against 64K elements while one writer appends
+// an element every 10ms.
+constexpr std::int64_t element_count = 1 << 16;
+constexpr std::int64_t lookups_per_thread = 1 << 20;
+
+// The pattern snapshot_vector_of_unique replaces: a reader-writer lock.
+class rw_locked_vector_of_unique {
+ public:
+  explicit rw_locked_vector_of_unique(vector_of_unique<int> v)
+      : v_(std::move(v)) {}
+
+  std::size_t index_of(int key) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return v_.index_of(key);
+  }
+  bool push_back(int value) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    return v_.push_back(value);
+  }
+
+ private:
+  mutable std::shared_mutex mutex_;
+  vector_of_unique<int> v_;
+};
+
+template <class C>
+void bm_read_mostly(benchmark::State& state) {
+  auto threads = static_cast<std::size_t>(state.range(0));
+  for (auto _ : state) {
+    state.PauseTiming();
+    vector_of_unique<int> initial;
+    for (int i = 0; i < element_count; ++i) {
+      initial.push_back(i);
+    }
+    C c(std::move(initial));
+    state.ResumeTiming();
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+      for (int i = element_count; !done.load(); ++i) {
+        c.push_back(i);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+    });
+    std::vector<std::thread> readers;
+    for (std::size_t t = 0; t < threads; ++t) {
+      readers.emplace_back([&c] {
+        std::size_t found = 0;
+        for (std::int64_t i = 0; i < lookups_per_thread; ++i) {
+          auto key = static_cast<int>((i * 7919) % (2 * element_count));
+          found += c.index_of(key) != vector_of_unique<int>::npos ? 1 : 0;
+        }
+        benchmark::DoNotOptimize(found);
+      });
+    }
+    for (auto& r : readers) {
+      r.join();
+    }
+    done = true;
+    writer.join();
+  }
+  state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) *
+                          lookups_per_thread * state.range(0));
+}
+
+int main(int argc, char** argv) {
+  benchmark::RegisterBenchmark("rw_locked_vector_of_unique<int>/index_of",
+                               bm_read_mostly<rw_locked_vector_of_unique>)
+      ->ArgName("threads")
+      ->DenseRange(1, 8, 1)
+      ->UseRealTime();
+  benchmark::RegisterBenchmark("snapshot_vector_of_unique<int>/index_of",
+                               bm_read_mostly<snapshot_vector_of_unique<int>>)
+      ->ArgName("threads")
+      ->DenseRange(1, 8, 1)
+      ->UseRealTime();
+
+  return bench::run(argc, argv);
+}
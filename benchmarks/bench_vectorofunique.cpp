@@ -0,0 +1,53 @@
+#include <vector>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "bench_common.h"
+#include "vectorofunique.h"
+
+using containerofunique::bloom_filter;
+using containerofunique::flat_index;
+using containerofunique::vector_of_unique;
+
+template <class T, class Hash = std::hash<T>>
+using flat_vector_of_unique =
+    vector_of_unique<T, Hash, std::equal_to<T>, std::allocator<T>, flat_index>;
+
+template <class T, class Hash = std::hash<T>>
+using bloom_vector_of_unique =
+    vector_of_unique<T, Hash, std::equal_to<T>, std::allocator<T>,
+                     bloom_filter<>>;
+
+int main(int argc, char** argv) {
+  using bench::LargeStruct;
+  using bench::LargeStructHash;
+
+  bench::register_container<vector_of_unique<int>>("vector_of_unique<int>");
+  bench::register_container<vector_of_unique<std::string>>(
+      "vector_of_unique<string>");
+  bench::register_container<vector_of_unique<LargeStruct, LargeStructHash>>(
+      "vector_of_unique<LargeStruct>");
+  bench::register_container<flat_vector_of_unique<int>>(
+      "flat_vector_of_unique<int>");
+  bench::register_container<flat_vector_of_unique<std::string>>(
+      "flat_vector_of_unique<string>");
+  bench::register_container<
+      flat_vector_of_unique<LargeStruct, LargeStructHash>>(
+      "flat_vector_of_unique<LargeStruct>");
+  bench::register_container<bloom_vector_of_unique<int>>(
+      "bloom_vector_of_unique<int>");
+  bench::register_container<bloom_vector_of_unique<std::string>>(
+      "bloom_vector_of_unique<string>");
+
+  bench::register_baseline<
+      bench::raw_unique<std::vector<int>, std::hash<int>>>("raw_vector<int>");
+  bench::register_baseline<
+      bench::raw_unique<std::vector<std::string>, std::hash<std::string>>>(
+      "raw_vector<string>");
+  bench::register_baseline<
+      bench::raw_unique<std::vector<LargeStruct>, LargeStructHash>>(
+      "raw_vector<LargeStruct>");
+
+  return bench::run(argc, argv);
+}
@@ -0,0 +1,592 @@
+#pragma once
+
+#include <algorithm>  // For std::equal
+#include <cstddef>    // For std::ptrdiff_t
+#include <functional>  // For std::hash
+#include <initializer_list>
+#include <iterator>  // For std::bidirectional_iterator_tag
+#include <memory>    // For std::allocator, std::allocator_traits
+#include <type_traits>
+#include <utility>  // For std::swap
+
+#include "hashindex.h"
+
+#ifndef NOEXCEPT_CXX17
+#if __cplusplus >= 201703L
+#define NOEXCEPT_CXX17 noexcept
+#else
+#define NOEXCEPT_CXX17
+#endif
+#endif
+
+namespace containerofunique {
+
+// Eviction policies for bounded_deque_of_unique.
+
+// Pushing an element that is already present leaves the order unchanged, so
+// elements are evicted in the order they were first pushed.
+struct fifo_eviction {};
+
+// Pushing an element that is already present moves it to the end it was
+// pushed to, so the least recently pushed element is evicted first.
+struct lru_eviction {};
+
+// Fixed-capacity deque of unique elements. Pushing a new element onto a full
+// container evicts one from the opposite end: push_back evicts the front,
+// push_front evicts the back.
+//
+// All storage is allocated at construction. Elements live in a slab of
+// capacity() + 1 nodes linked into a list, and the index is sized for as
+// many entries up front, so with the default flat_index a full container
+// keeps pushing and evicting without allocating. The spare node lets a push
+// onto a full container construct and index the new element before it
+// evicts, so a push that throws leaves the container unchanged. Moving an
+// element for lru_eviction is O(1) relinking.
+template <class T, class EvictionPolicy = fifo_eviction,
+          class Hash = std::hash<T>, class KeyEqual = std::equal_to<T>,
+          class Allocator = std::allocator<T>, class IndexPolicy = flat_index>
+class bounded_deque_of_unique {
+ public:
+  // *Member types
+  using value_type = T;
+  using key_type = T;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+  using allocator_type = Allocator;
+  using eviction_policy = EvictionPolicy;
+  using const_reference = const value_type&;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+
+  class const_iterator {
+   public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T*;
+    using reference = const T&;
+
+    const_iterator() noexcept = default;
+
+    reference operator*() const { return c_->_value(slot_); }
+    pointer operator->() const { return &c_->_value(slot_); }
+
+    const_iterator& operator++() {
+      slot_ = c_->nodes_[slot_].next;
+      return *this;
+    }
+    const_iterator operator++(int) {
+      auto tmp = *this;
+      ++*this;
+      return tmp;
+    }
+    const_iterator& operator--() {
+      slot_ = slot_ == npos ? c_->tail_ : c_->nodes_[slot_].prev;
+      return *this;
+    }
+    const_iterator operator--(int) {
+      auto tmp = *this;
+      --*this;
+      return tmp;
+    }
+
+    friend bool operator==(const const_iterator& lhs,
+                           const const_iterator& rhs) noexcept {
+      return lhs.slot_ == rhs.slot_;
+    }
+    friend bool operator!=(const const_iterator& lhs,
+                           const const_iterator& rhs) noexcept {
+      return lhs.slot_ != rhs.slot_;
+    }
+
+   private:
+    friend class bounded_deque_of_unique;
+
+    const_iterator(const bounded_deque_of_unique* c, size_type slot) noexcept
+        : c_(c), slot_(slot) {}
+
+    const bounded_deque_of_unique* c_ = nullptr;
+    size_type slot_ = npos;
+  };
+
+  using iterator = const_iterator;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+  using reverse_iterator = const_reverse_iterator;
+
+  // Member functions
+  // Constructor
+  explicit bounded_deque_of_unique(size_type capacity,
+                                   const Allocator& alloc = Allocator())
+      : alloc_(alloc), index_(alloc) {
+    _allocate(capacity);
+  }
+
+  template <class input_it>
+  bounded_deque_of_unique(size_type capacity, input_it first, input_it last,
+                          const Allocator& alloc = Allocator())
+      : bounded_deque_of_unique(capacity, alloc) {
+    for (; first != last; ++first) {
+      push_back(*first);
+    }
+  }
+
+  bounded_deque_of_unique(size_type capacity, std::initializer_list<T> init,
+                          const Allocator& alloc = Allocator())
+      : bounded_deque_of_unique(capacity, init.begin(), init.end(), alloc) {}
+
+  bounded_deque_of_unique(const bounded_deque_of_unique& other)
+      : bounded_deque_of_unique(
+            other, alloc_traits::select_on_container_copy_construction(
+                       other.get_allocator())) {}
+
+  bounded_deque_of_unique(const bounded_deque_of_unique& other,
+                          const Allocator& alloc)
+      : alloc_(alloc),
+        index_(alloc),
+        hash_(other.hash_),
+        eq_(other.eq_) {
+    _allocate(other.capacity_);
+    for (auto s = other.head_; s != npos; s = other.nodes_[s].next) {
+      _push(other._hash_at(s), other._value(s), back_tag());
+    }
+  }
+
+  // The moved-from container is left empty with capacity 0.
+  bounded_deque_of_unique(bounded_deque_of_unique&& other) NOEXCEPT_CXX17
+      : alloc_(std::move(other.alloc_)),
+        index_(std::move(other.index_)),
+        hash_(std::move(other.hash_)),
+        eq_(std::move(other.eq_)) {
+    _steal(other);
+  }
+
+  bounded_deque_of_unique(bounded_deque_of_unique&& other,
+                          const Allocator& alloc)
+      : alloc_(alloc), index_(alloc), hash_(other.hash_), eq_(other.eq_) {
+    if (alloc_ == other.alloc_) {
+      index_ = std::move(other.index_);
+      _steal(other);
+    } else {
+      _allocate(other.capacity_);
+      for (auto s = other.head_; s != npos; s = other.nodes_[s].next) {
+        _push(other._hash_at(s), std::move(other._value(s)), back_tag());
+      }
+    }
+  }
+
+  bounded_deque_of_unique& operator=(const bounded_deque_of_unique& other) {
+    if (this != &other) {
+      bounded_deque_of_unique tmp(other, alloc_);
+      _swap_storage(tmp);
+    }
+    return *this;
+  }
+
+  bounded_deque_of_unique& operator=(bounded_deque_of_unique&& other) {
+    if (this != &other) {
+      bounded_deque_of_unique tmp(std::move(other), alloc_);
+      _swap_storage(tmp);
+    }
+    return *this;
+  }
+
+  ~bounded_deque_of_unique() { _deallocate(); }
+
+  // Element access
+  const_reference front() const { return _value(head_); }
+  const_reference back() const { return _value(tail_); }
+
+  // Iterators
+  const_iterator cbegin() const noexcept { return const_iterator(this, head_); }
+  const_iterator cend() const noexcept { return const_iterator(this, npos); }
+
+  iterator begin() const noexcept { return cbegin(); }
+  iterator end() const noexcept { return cend(); }
+
+  const_reverse_iterator crbegin() const noexcept {
+    return const_reverse_iterator(cend());
+  }
+  const_reverse_iterator crend() const noexcept {
+    return const_reverse_iterator(cbegin());
+  }
+
+  reverse_iterator rbegin() const noexcept { return crbegin(); }
+  reverse_iterator rend() const noexcept { return crend(); }
+
+  // Modifiers
+  void clear() noexcept {
+    while (head_ != npos) {
+      auto next = nodes_[head_].next;
+      _destroy(head_);
+      head_ = next;
+    }
+    tail_ = npos;
+    size_ = 0;
+    index_.clear();
+    _reset_free_list();
+  }
+
+  // Precondition: pos must be a valid and dereferenceable iterator of this
+  // container.
+  const_iterator erase(const_iterator pos) {
+    auto next = nodes_[pos.slot_].next;
+    _erase(pos.slot_);
+    return const_iterator(this, next);
+  }
+
+  void pop_front() {
+    if (head_ != npos) {
+      _erase(head_);
+    }
+  }
+
+  void pop_back() {
+    if (tail_ != npos) {
+      _erase(tail_);
+    }
+  }
+
+  // Appends value if it is not present, evicting the front element when the
+  // container is full. Under lru_eviction an element that is already
+  // present is moved to the back instead. Returns true if value was added.
+  bool push_back(const T& value) {
+    return _push(hash_(value), value, back_tag());
+  }
+
+  bool push_back(T&& value) {
+    return _push(hash_(value), std::move(value), back_tag());
+  }
+
+  // Prepends value if it is not present, evicting the back element when the
+  // container is full. Under lru_eviction an element that is already
+  // present is moved to the front instead. Returns true if value was added.
+  bool push_front(const T& value) {
+    return _push(hash_(value), value, front_tag());
+  }
+
+  bool push_front(T&& value) {
+    return _push(hash_(value), std::move(value), front_tag());
+  }
+
+  // Removes every element for which pred returns true. Returns the number of
+  // elements removed.
+  template <class Pred>
+  size_type remove_if(Pred pred) {
+    size_type removed = 0;
+    for (auto s = head_; s != npos;) {
+      auto next = nodes_[s].next;
+      if (pred(static_cast<const T&>(_value(s)))) {
+        _erase(s);
+        ++removed;
+      }
+      s = next;
+    }
+    return removed;
+  }
+
+  void swap(bounded_deque_of_unique& other) noexcept {
+    _swap_storage(other);
+    _swap_alloc(other, typename alloc_traits::propagate_on_container_swap());
+  }
+
+  // Capacity
+  bool empty() const noexcept { return size_ == 0; }
+  bool full() const noexcept { return size_ == capacity_; }
+  size_type size() const noexcept { return size_; }
+  size_type capacity() const noexcept { return capacity_; }
+
+  // Look up
+  const_iterator find(const key_type& key) const {
+    auto p = _find(hash_(key), key);
+    return const_iterator(this, p == nullptr ? npos : *p);
+  }
+
+#if __cplusplus >= 202002L
+  bool contains(const key_type& key) const {
+    return _find(hash_(key), key) != nullptr;
+  }
+#endif
+
+  // Observers
+  allocator_type get_allocator() const noexcept { return alloc_; }
+  hasher hash_function() const { return hash_; }
+  key_equal key_eq() const { return eq_; }
+
+ private:
+  static constexpr size_type npos = static_cast<size_type>(-1);
+
+  using alloc_traits = std::allocator_traits<Allocator>;
+  using index_type = typename IndexPolicy::template type<size_type, Allocator>;
+
+  struct node {
+    alignas(T) unsigned char storage[sizeof(T)];
+    size_type prev;
+    size_type next;
+  };
+
+  using node_allocator = typename alloc_traits::template rebind_alloc<node>;
+  using node_traits = std::allocator_traits<node_allocator>;
+
+  using back_tag = std::true_type;
+  using front_tag = std::false_type;
+
+  T& _value(size_type slot) const noexcept {
+    return *reinterpret_cast<T*>(nodes_[slot].storage);
+  }
+
+  template <class K>
+  const size_type* _find(std::size_t hash, const K& key) const {
+    return index_.find(hash,
+                       [&](size_type slot) { return eq_(_value(slot), key); });
+  }
+
+  template <class V, class AtBack>
+  bool _push(std::size_t hash, V&& value, AtBack at_back) {
+    auto p = _find(hash, value);
+    if (p != nullptr) {
+      _touch(*p, at_back, EvictionPolicy());
+      return false;
+    }
+    if (capacity_ == 0) {
+      return false;
+    }
+    auto victim = npos;
+    std::size_t victim_hash = 0;
+    if (size_ == capacity_) {
+      victim = at_back ? head_ : tail_;
+      victim_hash = _hash_at(victim);
+    }
+
+    auto slot = free_;
+    alloc_traits::construct(alloc_, &_value(slot), std::forward<V>(value));
+    try {
+      index_.insert(hash, slot);
+    } catch (...) {
+      alloc_traits::destroy(alloc_, &_value(slot));
+      throw;
+    }
+    free_ = nodes_[slot].next;
+    if (victim != npos) {
+      _erase(victim, victim_hash);
+    }
+    _link(slot, at_back);
+    ++size_;
+    return true;
+  }
+
+  template <class AtBack>
+  void _touch(size_type, AtBack, fifo_eviction) noexcept {}
+
+  template <class AtBack>
+  void _touch(size_type slot, AtBack at_back, lru_eviction) noexcept {
+    _unlink(slot);
+    _link(slot, at_back);
+  }
+
+  void _link(size_type slot, back_tag) noexcept {
+    nodes_[slot].prev = tail_;
+    nodes_[slot].next = npos;
+    if (tail_ != npos) {
+      nodes_[tail_].next = slot;
+    } else {
+      head_ = slot;
+    }
+    tail_ = slot;
+  }
+
+  void _link(size_type slot, front_tag) noexcept {
+    nodes_[slot].prev = npos;
+    nodes_[slot].next = head_;
+    if (head_ != npos) {
+      nodes_[head_].prev = slot;
+    } else {
+      tail_ = slot;
+    }
+    head_ = slot;
+  }
+
+  void _unlink(size_type slot) noexcept {
+    const auto& n = nodes_[slot];
+    if (n.prev != npos) {
+      nodes_[n.prev].next = n.next;
+    } else {
+      head_ = n.next;
+    }
+    if (n.next != npos) {
+      nodes_[n.next].prev = n.prev;
+    } else {
+      tail_ = n.prev;
+    }
+  }
+
+  // Hash of the value in slot, taken from the index when it caches hashes.
+  std::size_t _hash_at(size_type slot) const {
+    return index_.hash_at(slot, [&] { return hash_(_value(slot)); });
+  }
+
+  void _erase(size_type slot) { _erase(slot, _hash_at(slot)); }
+
+  void _erase(size_type slot, std::size_t hash) {
+    index_.erase(hash, slot);
+    _unlink(slot);
+    _destroy(slot);
+    nodes_[slot].next = free_;
+    free_ = slot;
+    --size_;
+  }
+
+  void _destroy(size_type slot) noexcept {
+    alloc_traits::destroy(alloc_, &_value(slot));
+  }
+
+  // capacity nodes plus the spare one, or none for a zero capacity.
+  static size_type _node_count(size_type capacity) noexcept {
+    return capacity == 0 ? 0 : capacity + 1;
+  }
+
+  void _reset_free_list() noexcept {
+    auto count = _node_count(capacity_);
+    for (size_type i = 0; i < count; ++i) {
+      nodes_[i].next = i + 1 < count ? i + 1 : npos;
+    }
+    free_ = count == 0 ? npos : 0;
+  }
+
+  void _allocate(size_type capacity) {
+    if (capacity != 0) {
+      node_allocator na(alloc_);
+      nodes_ = node_traits::allocate(na, _node_count(capacity));
+      try {
+        index_.reserve(_node_count(capacity));
+      } catch (...) {
+        node_traits::deallocate(na, nodes_, _node_count(capacity));
+        nodes_ = nullptr;
+        throw;
+      }
+    }
+    capacity_ = capacity;
+    _reset_free_list();
+  }
+
+  void _deallocate() noexcept {
+    clear();
+    if (nodes_ != nullptr) {
+      node_allocator na(alloc_);
+      node_traits::deallocate(na, nodes_, _node_count(capacity_));
+    }
+    nodes_ = nullptr;
+    capacity_ = 0;
+    free_ = npos;
+  }
+
+  void _steal(bounded_deque_of_unique& other) noexcept {
+    nodes_ = other.nodes_;
+    capacity_ = other.capacity_;
+    size_ = other.size_;
+    head_ = other.head_;
+    tail_ = other.tail_;
+    free_ = other.free_;
+    other.nodes_ = nullptr;
+    other.capacity_ = 0;
+    other.size_ = 0;
+    other.head_ = npos;
+    other.tail_ = npos;
+    other.free_ = npos;
+    other.index_.clear();
+  }
+
+  void _swap_storage(bounded_deque_of_unique& other) noexcept {
+    using std::swap;
+    index_.swap(other.index_);
+    swap(nodes_, other.nodes_);
+    swap(capacity_, other.capacity_);
+    swap(size_, other.size_);
+    swap(head_, other.head_);
+    swap(tail_, other.tail_);
+    swap(free_, other.free_);
+    swap(hash_, other.hash_);
+    swap(eq_, other.eq_);
+  }
+
+  void _swap_alloc(bounded_deque_of_unique& other, std::true_type) noexcept {
+    using std::swap;
+    swap(alloc_, other.alloc_);
+  }
+  void _swap_alloc(bounded_deque_of_unique&, std::false_type) noexcept {}
+
+  Allocator alloc_;
+  // Slab of capacity_ + 1 nodes. Live nodes form a list from head_ to
+  // tail_; free nodes, including the spare, are chained through next from
+  // free_.
+  node* nodes_ = nullptr;
+  size_type capacity_ = 0;
+  size_type size_ = 0;
+  size_type head_ = npos;
+  size_type tail_ = npos;
+  size_type free_ = npos;
+  // Maps element hashes to node slots, which never move.
+  index_type index_;
+  Hash hash_;
+  KeyEqual eq_;
+};  // class bounded_deque_of_unique
+
+#if __cplusplus < 201703L
+template <class T, class EvictionPolicy, class Hash, class KeyEqual,
+          class Allocator, class IndexPolicy>
+constexpr typename bounded_deque_of_unique<T, EvictionPolicy, Hash, KeyEqual,
+                                           Allocator, IndexPolicy>::size_type
+    bounded_deque_of_unique<T, EvictionPolicy, Hash, KeyEqual, Allocator,
+                            IndexPolicy>::npos;
+#endif
+
+// Non-member functions
+template <class T, class EvictionPolicy, class Hash, class KeyEqual,
+          class Allocator, class IndexPolicy, class U = T>
+typename bounded_deque_of_unique<T, EvictionPolicy, Hash, KeyEqual, Allocator,
+                                 IndexPolicy>::size_type
+erase(bounded_deque_of_unique<T, EvictionPolicy, Hash, KeyEqual, Allocator,
+                              IndexPolicy>& c,
+      const U& value) {
+  auto it = c.find(value);
+  if (it != c.cend()) {
+    c.erase(it);
+    return 1;
+  }
+  return 0;
+}
+
+template <class T, class EvictionPolicy, class Hash, class KeyEqual,
+          class Allocator, class IndexPolicy, class Pred>
+typename bounded_deque_of_unique<T, EvictionPolicy, Hash, KeyEqual, Allocator,
+                                 IndexPolicy>::size_type
+erase_if(bounded_deque_of_unique<T, EvictionPolicy, Hash, KeyEqual, Allocator,
+                                 IndexPolicy>& c,
+         Pred pred) {
+  return c.remove_if(pred);
+}
+
+// Operators
+template <class T, class EvictionPolicy, class Hash, class KeyEqual,
+          class Allocator, class IndexPolicy>
+bool operator==(const bounded_deque_of_unique<T, EvictionPolicy, Hash,
+                                              KeyEqual, Allocator,
+                                              IndexPolicy>& lhs,
+                const bounded_deque_of_unique<T, EvictionPolicy, Hash,
+                                              KeyEqual, Allocator,
+                                              IndexPolicy>& rhs) {
+  return lhs.size() == rhs.size() &&
+         std::equal(lhs.cbegin(), lhs.cend(), rhs.cbegin());
+}
+
+template <class T, class EvictionPolicy, class Hash, class KeyEqual,
+          class Allocator, class IndexPolicy>
+bool operator!=(const bounded_deque_of_unique<T, EvictionPolicy, Hash,
+                                              KeyEqual, Allocator,
+                                              IndexPolicy>& lhs,
+                const bounded_deque_of_unique<T, EvictionPolicy, Hash,
+                                              KeyEqual, Allocator,
+                                              IndexPolicy>& rhs) {
+  return !(lhs == rhs);
+}
+
+}  // namespace containerofunique
@@ -0,0 +1,268 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>     // For std::size_t
+#include <cstdint>     // For std::uint64_t
+#include <deque>       // For std::deque
+#include <functional>  // For std::hash
+#include <memory>      // For std::allocator, std::allocator_traits
+#include <mutex>
+#include <thread>   // For std::thread::hardware_concurrency
+#include <utility>  // For std::forward, std::move
+
+#include "dequeofunique.h"
+#include "hashindex.h"
+
+namespace containerofunique {
+
+// Thread-safe work queue that holds each item at most once. Pushing an item
+// that is still pending is rejected, so an item can be enqueued again only
+// after a consumer has popped it.
+//
+// Items are spread by hash over shard_count() shards, each a
+// deque_of_unique behind its own mutex, so an item always lands in the same
+// shard and the pending check stays exact. Producers pushing different
+// items rarely contend, and consumers start scanning at a different shard
+// per thread and skip empty shards without locking them. Items pop in FIFO
+// order within a shard; a queue built with one shard is strictly FIFO.
+//
+// Hashes are computed before any lock is taken, and the default
+// cached_hash<flat_index> index reuses them on pop and neither allocates
+// nor rehashes in steady state, so each critical section is a probe and a
+// deque push or pop. Consumers that drain with pop_n lock each shard once
+// per batch. Producers only touch the shared wait mutex when a consumer is
+// asleep.
+//
+// close() rejects further pushes and wakes every waiting consumer, which
+// then drain the remaining items. Popped items are moved out of the queue.
+template <class T, class Hash = std::hash<T>, class KeyEqual = std::equal_to<T>,
+          class Allocator = std::allocator<T>,
+          class IndexPolicy = cached_hash<flat_index>>
+class concurrent_dedup_queue {
+ public:
+  // *Member types
+  using value_type = T;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+  using allocator_type = Allocator;
+  using queue_type = deque_of_unique<T, Hash, KeyEqual, Allocator, IndexPolicy>;
+  using size_type = typename queue_type::size_type;
+
+  // Member functions
+  // Constructor. shard_count is rounded up to a power of two.
+  concurrent_dedup_queue() : concurrent_dedup_queue(default_shard_count()) {}
+
+  explicit concurrent_dedup_queue(const Allocator& alloc)
+      : concurrent_dedup_queue(default_shard_count(), alloc) {}
+
+  explicit concurrent_dedup_queue(size_type shard_count,
+                                  const Allocator& alloc = Allocator())
+      : alloc_(alloc), shards_(shard_allocator(alloc)) {
+    size_type count = 1;
+    while (count < shard_count && count < max_shard_count) {
+      count *= 2;
+    }
+    shard_mask_ = count - 1;
+    for (size_type i = 0; i < count; ++i) {
+      shards_.emplace_back(alloc);
+    }
+  }
+
+  concurrent_dedup_queue(const concurrent_dedup_queue&) = delete;
+  concurrent_dedup_queue& operator=(const concurrent_dedup_queue&) = delete;
+
+  // Modifiers
+  // Enqueues value unless it is already pending or the queue is closed.
+  // Returns true if value was enqueued.
+  bool push(const T& value) { return _push(hash_(value), value); }
+
+  bool push(T&& value) { return _push(hash_(value), std::move(value)); }
+
+  // Blocks until an item is available, then pops it into out. Returns false
+  // only once the queue is closed and empty.
+  bool pop(T& out) { return _wait_pop_n(&out, 1) == 1; }
+
+  // Pops an item into out if one is available, without blocking.
+  bool try_pop(T& out) { return _try_pop_n(&out, 1) == 1; }
+
+  // Blocks until an item is available, then pops up to n items through
+  // out. Returns the number popped, which is 0 only once the queue is closed
+  // and empty (or n is 0).
+  template <class output_it>
+  size_type pop_n(output_it out, size_type n) {
+    return _wait_pop_n(out, n);
+  }
+
+  // Pops up to n items through out without blocking; returns the number
+  // popped.
+  template <class output_it>
+  size_type try_pop_n(output_it out, size_type n) {
+    return _try_pop_n(out, n);
+  }
+
+  // Rejects further pushes and wakes every blocked consumer.
+  void close() {
+    closed_.store(true);
+    // A push that saw closed_ unset still holds its shard's mutex, so
+    // taking each one once waits it out.
+    for (auto& s : shards_) {
+      std::lock_guard<std::mutex> lock(s.mutex);
+    }
+    {
+      std::lock_guard<std::mutex> lock(wait_mutex_);
+      sealed_.store(true);
+    }
+    ready_.notify_all();
+  }
+
+  // Capacity. These are snapshots that other threads may invalidate at
+  // once.
+  bool closed() const { return closed_.load(); }
+
+  bool empty() const { return !_has_items(); }
+
+  size_type size() const {
+    size_type n = 0;
+    for (const auto& s : shards_) {
+      n += s.count.load();
+    }
+    return n;
+  }
+
+  size_type shard_count() const noexcept { return shards_.size(); }
+
+  // Observers
+  allocator_type get_allocator() const noexcept { return alloc_; }
+  hasher hash_function() const { return hash_; }
+  key_equal key_eq() const { return shards_.front().queue.key_eq(); }
+
+  // One shard per hardware thread.
+  static size_type default_shard_count() noexcept {
+    auto threads = std::thread::hardware_concurrency();
+    return threads == 0 ? 8 : static_cast<size_type>(threads);
+  }
+
+ private:
+  using alloc_traits = std::allocator_traits<Allocator>;
+
+  // Shards are padded apart so that threads locking neighbouring shards do
+  // not share a cache line. count mirrors queue.size() so that consumers
+  // and the wake-up check can read it without the mutex.
+  struct shard {
+    explicit shard(const Allocator& alloc) : queue(alloc) {}
+
+    std::mutex mutex;
+    std::atomic<size_type> count{0};
+    queue_type queue;
+    char padding[64];
+  };
+
+  using shard_allocator = typename alloc_traits::template rebind_alloc<shard>;
+
+  static constexpr size_type max_shard_count = size_type{1} << 10;
+
+  // Takes the shard from bits the index's own probing barely uses.
+  shard& _shard_of(std::size_t hash) noexcept {
+    auto m = static_cast<std::uint64_t>(hash) * 0x9E3779B97F4A7C15ull;
+    return shards_[static_cast<size_type>(m >> 32) & shard_mask_];
+  }
+
+  template <class V>
+  bool _push(std::size_t hash, V&& value) {
+    auto& s = _shard_of(hash);
+    {
+      std::lock_guard<std::mutex> lock(s.mutex);
+      if (closed_.load(std::memory_order_relaxed) ||
+          !s.queue.insert_with_hash(std::forward<V>(value), hash)) {
+        return false;
+      }
+      // Sequentially consistent, like the increment of sleepers_ in
+      // _wait_pop_n, so that either this push sees the sleeper or the
+      // sleeper sees the item.
+      s.count.fetch_add(1);
+    }
+    if (sleepers_.load() != 0) {
+      { std::lock_guard<std::mutex> lock(wait_mutex_); }
+      ready_.notify_one();
+    }
+    return true;
+  }
+
+  bool _has_items() const {
+    for (const auto& s : shards_) {
+      if (s.count.load() != 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Each thread starts its scans at its own shard and moves on by one per
+  // scan, so consumers spread out without sharing a counter.
+  size_type _scan_start() const {
+    static thread_local size_type next =
+        std::hash<std::thread::id>()(std::this_thread::get_id());
+    return next++;
+  }
+
+  template <class output_it>
+  size_type _try_pop_n(output_it out, size_type n) {
+    size_type popped = 0;
+    auto start = _scan_start();
+    for (size_type i = 0; i <= shard_mask_ && popped != n; ++i) {
+      auto& s = shards_[(start + i) & shard_mask_];
+      if (s.count.load(std::memory_order_relaxed) == 0) {
+        continue;
+      }
+      std::lock_guard<std::mutex> lock(s.mutex);
+      popped += _pop_n(s, out, n - popped);
+    }
+    return popped;
+  }
+
+  template <class output_it>
+  size_type _wait_pop_n(output_it out, size_type n) {
+    for (;;) {
+      auto popped = _try_pop_n(out, n);
+      if (popped != 0 || n == 0) {
+        return popped;
+      }
+      std::unique_lock<std::mutex> lock(wait_mutex_);
+      sleepers_.fetch_add(1);
+      ready_.wait(lock, [this] { return _has_items() || sealed_.load(); });
+      sleepers_.fetch_sub(1);
+      // No push can land once sealed_ is set, so an empty queue stays empty.
+      if (sealed_.load() && !_has_items()) {
+        return 0;
+      }
+    }
+  }
+
+  // Caller holds s.mutex. Items are extracted, which reuses their cached
+  // hashes, and moved out rather than copied.
+  template <class output_it>
+  size_type _pop_n(shard& s, output_it& out, size_type n) {
+    size_type popped = 0;
+    for (; popped != n && !s.queue.empty(); ++popped) {
+      auto nh = s.queue.extract(s.queue.cbegin());
+      s.count.fetch_sub(1, std::memory_order_relaxed);
+      *out = std::move(nh.value());
+      ++out;
+    }
+    return popped;
+  }
+
+  Allocator alloc_;
+  std::deque<shard, shard_allocator> shards_;
+  size_type shard_mask_ = 0;
+  std::atomic<size_type> sleepers_{0};
+  std::atomic<bool> closed_{false};
+  // Set by close() once no push can still land.
+  std::atomic<bool> sealed_{false};
+  std::mutex wait_mutex_;
+  std::condition_variable ready_;
+  Hash hash_;
+};
+
+}  // namespace containerofunique
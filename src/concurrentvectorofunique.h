@@ -0,0 +1,478 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>     // For std::ptrdiff_t
+#include <cstdint>     // For std::uint64_t
+#include <deque>       // For std::deque
+#include <functional>  // For std::hash
+#include <initializer_list>
+#include <iterator>  // For std::random_access_iterator_tag
+#include <limits>
+#include <memory>  // For std::allocator, std::allocator_traits
+#include <mutex>
+#include <stdexcept>  // For std::length_error
+#include <thread>     // For std::thread::hardware_concurrency
+#include <type_traits>
+#include <utility>  // For std::forward, std::move
+
+#include "hashindex.h"
+
+namespace containerofunique {
+
+// Append-only vector of unique elements that many threads may push to and
+// read from at once.
+//
+// The uniqueness index is split into shard_count() shards, each guarded by
+// its own mutex and chosen by the element's hash, so threads pushing
+// different elements rarely contend. Elements live in a segmented store
+// whose segments double in size and never move, so a reference to an
+// element stays valid for the container's lifetime.
+//
+// Each push claims the next position with one atomic operation and
+// constructs the element there. size() only advances over positions whose
+// elements are fully constructed, so size(), operator[] and iteration see a
+// consistent prefix of the sequence without locking anything. begin() and
+// end() each read size() once; a range-for loop therefore walks the prefix
+// that was visible when it started.
+//
+// Elements cannot be erased. T must be nothrow move constructible, and the
+// allocator must be safe to call from several threads.
+template <class T, class Hash = std::hash<T>, class KeyEqual = std::equal_to<T>,
+          class Allocator = std::allocator<T>, class IndexPolicy = flat_index>
+class concurrent_vector_of_unique {
+  static_assert(std::is_nothrow_move_constructible<T>::value,
+                "concurrent_vector_of_unique requires a nothrow move "
+                "constructible element type");
+
+ public:
+  // *Member types
+  using value_type = T;
+  using key_type = T;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+  using allocator_type = Allocator;
+  using const_reference = const value_type&;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+
+  class const_iterator {
+   public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T*;
+    using reference = const T&;
+
+    const_iterator() noexcept = default;
+
+    reference operator*() const { return c_->_value(pos_); }
+    pointer operator->() const { return &c_->_value(pos_); }
+    reference operator[](difference_type n) const { return *(*this + n); }
+
+    const_iterator& operator++() noexcept {
+      ++pos_;
+      return *this;
+    }
+    const_iterator operator++(int) noexcept {
+      auto tmp = *this;
+      ++pos_;
+      return tmp;
+    }
+    const_iterator& operator--() noexcept {
+      --pos_;
+      return *this;
+    }
+    const_iterator operator--(int) noexcept {
+      auto tmp = *this;
+      --pos_;
+      return tmp;
+    }
+    const_iterator& operator+=(difference_type n) noexcept {
+      pos_ += n;
+      return *this;
+    }
+    const_iterator& operator-=(difference_type n) noexcept {
+      pos_ -= n;
+      return *this;
+    }
+
+    friend const_iterator operator+(const_iterator it,
+                                    difference_type n) noexcept {
+      return it += n;
+    }
+    friend const_iterator operator+(difference_type n,
+                                    const_iterator it) noexcept {
+      return it += n;
+    }
+    friend const_iterator operator-(const_iterator it,
+                                    difference_type n) noexcept {
+      return it -= n;
+    }
+    friend difference_type operator-(const const_iterator& lhs,
+                                     const const_iterator& rhs) noexcept {
+      return static_cast<difference_type>(lhs.pos_) -
+             static_cast<difference_type>(rhs.pos_);
+    }
+
+    friend bool operator==(const const_iterator& lhs,
+                           const const_iterator& rhs) noexcept {
+      return lhs.pos_ == rhs.pos_;
+    }
+    friend bool operator!=(const const_iterator& lhs,
+                           const const_iterator& rhs) noexcept {
+      return lhs.pos_ != rhs.pos_;
+    }
+    friend bool operator<(const const_iterator& lhs,
+                          const const_iterator& rhs) noexcept {
+      return lhs.pos_ < rhs.pos_;
+    }
+    friend bool operator>(const const_iterator& lhs,
+                          const const_iterator& rhs) noexcept {
+      return rhs < lhs;
+    }
+    friend bool operator<=(const const_iterator& lhs,
+                           const const_iterator& rhs) noexcept {
+      return !(rhs < lhs);
+    }
+    friend bool operator>=(const const_iterator& lhs,
+                           const const_iterator& rhs) noexcept {
+      return !(lhs < rhs);
+    }
+
+   private:
+    friend class concurrent_vector_of_unique;
+
+    const_iterator(const concurrent_vector_of_unique* c, size_type pos) noexcept
+        : c_(c), pos_(pos) {}
+
+    const concurrent_vector_of_unique* c_ = nullptr;
+    size_type pos_ = 0;
+  };
+
+  using iterator = const_iterator;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+  using reverse_iterator = const_reverse_iterator;
+
+  // Member functions
+  // Constructor
+  explicit concurrent_vector_of_unique(
+      size_type shard_count = default_shard_count(),
+      const Allocator& alloc = Allocator())
+      : alloc_(alloc), shards_(shard_allocator(alloc)) {
+    size_type count = 1;
+    while (count < shard_count && count < max_shard_count) {
+      count *= 2;
+    }
+    shard_mask_ = count - 1;
+    for (size_type i = 0; i < count; ++i) {
+      shards_.emplace_back(alloc);
+    }
+    for (auto& segment : segments_) {
+      segment.store(nullptr, std::memory_order_relaxed);
+    }
+  }
+
+  template <class input_it>
+  concurrent_vector_of_unique(input_it first, input_it last,
+                              size_type shard_count = default_shard_count(),
+                              const Allocator& alloc = Allocator())
+      : concurrent_vector_of_unique(shard_count, alloc) {
+    for (; first != last; ++first) {
+      push_back(*first);
+    }
+  }
+
+  concurrent_vector_of_unique(std::initializer_list<T> init,
+                              size_type shard_count = default_shard_count(),
+                              const Allocator& alloc = Allocator())
+      : concurrent_vector_of_unique(init.begin(), init.end(), shard_count,
+                                    alloc) {}
+
+  concurrent_vector_of_unique(const concurrent_vector_of_unique&) = delete;
+  concurrent_vector_of_unique& operator=(const concurrent_vector_of_unique&) =
+      delete;
+
+  // Must not run concurrently with any other member function.
+  ~concurrent_vector_of_unique() {
+    auto n = claimed_.load(std::memory_order_acquire);
+    for (size_type pos = 0; pos < n; ++pos) {
+      alloc_traits::destroy(alloc_, &_value(pos));
+    }
+    for (size_type k = 0; k < max_segments; ++k) {
+      auto* segment = segments_[k].load(std::memory_order_relaxed);
+      if (segment != nullptr) {
+        cell_allocator cells(alloc_);
+        cell_traits::deallocate(cells, segment, _segment_size(k));
+      }
+    }
+  }
+
+  // Element access
+  // Precondition: pos < size() as observed by the calling thread.
+  const_reference operator[](size_type pos) const { return _value(pos); }
+
+  // Iterators
+  const_iterator cbegin() const noexcept { return const_iterator(this, 0); }
+  const_iterator cend() const noexcept { return const_iterator(this, size()); }
+
+  iterator begin() const noexcept { return cbegin(); }
+  iterator end() const noexcept { return cend(); }
+
+  const_reverse_iterator crbegin() const noexcept {
+    return const_reverse_iterator(cend());
+  }
+  const_reverse_iterator crend() const noexcept {
+    return const_reverse_iterator(cbegin());
+  }
+
+  reverse_iterator rbegin() const noexcept { return crbegin(); }
+  reverse_iterator rend() const noexcept { return crend(); }
+
+  // Modifiers
+  // Appends value if no equal element has been pushed. Safe to call from
+  // any number of threads; returns true if value was added.
+  bool push_back(const T& value) { return _push_back(hash_(value), value); }
+
+  bool push_back(T&& value) {
+    return _push_back(hash_(value), std::move(value));
+  }
+
+  template <class... Args>
+  bool emplace_back(Args&&... args) {
+    T value(std::forward<Args>(args)...);
+    auto h = hash_(value);
+    return _push_back(h, std::move(value));
+  }
+
+  // Capacity
+  bool empty() const noexcept { return size() == 0; }
+
+  // Number of elements visible to readers. Elements whose push is still in
+  // progress are not counted.
+  size_type size() const noexcept {
+    return size_.load(std::memory_order_acquire);
+  }
+
+  // Allocates the segments for n elements and sizes every shard's index for
+  // an even share of them, so pushes up to n allocate less. Thread-safe.
+  void reserve(size_type n) {
+    if (n == 0) {
+      return;
+    }
+    for (size_type k = 0; k <= _segment_of(n - 1); ++k) {
+      _ensure_segment(k);
+    }
+    auto per_shard = n / shards_.size() + n / shards_.size() / 4 + 1;
+    for (auto& s : shards_) {
+      std::lock_guard<std::mutex> lock(s.mutex);
+      s.index.reserve(per_shard);
+    }
+  }
+
+  size_type shard_count() const noexcept { return shards_.size(); }
+
+  // Look up. These lock the key's shard only. An element whose push is
+  // still in progress is found, but may not yet be counted by size().
+  const_iterator find(const key_type& key) const {
+    auto pos = index_of(key);
+    return pos == npos ? cend() : const_iterator(this, pos);
+  }
+
+  size_type index_of(const key_type& key) const {
+    auto h = hash_(key);
+    const auto& s = shards_[_shard_of(h)];
+    std::lock_guard<std::mutex> lock(s.mutex);
+    auto p = _find(s, h, key);
+    return p == nullptr ? npos : *p;
+  }
+
+#if __cplusplus >= 202002L
+  bool contains(const key_type& key) const { return index_of(key) != npos; }
+#endif
+
+  // Observers
+  allocator_type get_allocator() const noexcept { return alloc_; }
+  hasher hash_function() const { return hash_; }
+  key_equal key_eq() const { return eq_; }
+
+  static constexpr size_type npos = static_cast<size_type>(-1);
+
+  // Four shards per hardware thread keeps contention low at full load.
+  static size_type default_shard_count() noexcept {
+    auto threads = std::thread::hardware_concurrency();
+    return threads == 0 ? 16 : 4 * static_cast<size_type>(threads);
+  }
+
+ private:
+  using alloc_traits = std::allocator_traits<Allocator>;
+  using index_type = typename IndexPolicy::template type<size_type, Allocator>;
+
+  struct cell {
+    alignas(T) unsigned char storage[sizeof(T)];
+    std::atomic<bool> ready{false};
+  };
+
+  using cell_allocator = typename alloc_traits::template rebind_alloc<cell>;
+  using cell_traits = std::allocator_traits<cell_allocator>;
+
+  // Shards are padded apart so that threads locking neighbouring shards do
+  // not share a cache line.
+  struct shard {
+    explicit shard(const Allocator& alloc) : index(alloc) {}
+
+    mutable std::mutex mutex;
+    index_type index;
+    char padding[64];
+  };
+
+  using shard_allocator = typename alloc_traits::template rebind_alloc<shard>;
+
+  // Segment k holds first_segment_size << k elements, so the store never
+  // moves an element and finds any position with one bit scan.
+  static constexpr size_type first_segment_bits = 5;
+  static constexpr size_type first_segment_size = size_type{1}
+                                                  << first_segment_bits;
+  static constexpr size_type max_segments =
+      std::numeric_limits<size_type>::digits - first_segment_bits;
+  static constexpr size_type max_shard_count = size_type{1} << 16;
+
+  static size_type _segment_of(size_type pos) noexcept {
+    auto biased = static_cast<std::uint64_t>(pos) + first_segment_size;
+    return static_cast<size_type>(63 - detail::count_leading_zeros(biased)) -
+           first_segment_bits;
+  }
+
+  static size_type _segment_size(size_type k) noexcept {
+    return first_segment_size << k;
+  }
+
+  cell& _cell(size_type pos) const noexcept {
+    auto k = _segment_of(pos);
+    auto offset = pos + first_segment_size - _segment_size(k);
+    return segments_[k].load(std::memory_order_acquire)[offset];
+  }
+
+  T& _value(size_type pos) const noexcept {
+    return *reinterpret_cast<T*>(_cell(pos).storage);
+  }
+
+  // Installs segment k unless another thread already has.
+  void _ensure_segment(size_type k) {
+    if (k >= max_segments) {
+      throw std::length_error("concurrent_vector_of_unique too long");
+    }
+    if (segments_[k].load(std::memory_order_acquire) != nullptr) {
+      return;
+    }
+    cell_allocator cells(alloc_);
+    auto n = _segment_size(k);
+    auto* segment = cell_traits::allocate(cells, n);
+    for (size_type i = 0; i < n; ++i) {
+      ::new (static_cast<void*>(segment + i)) cell;
+    }
+    cell* expected = nullptr;
+    if (!segments_[k].compare_exchange_strong(expected, segment,
+                                              std::memory_order_acq_rel)) {
+      cell_traits::deallocate(cells, segment, n);
+    }
+  }
+
+  // Claims the next position. Its segment exists before the claim, so a
+  // claimed position is always constructed and eventually published.
+  size_type _claim() {
+    auto pos = claimed_.load(std::memory_order_relaxed);
+    for (;;) {
+      _ensure_segment(_segment_of(pos));
+      if (claimed_.compare_exchange_weak(pos, pos + 1)) {
+        return pos;
+      }
+    }
+  }
+
+  // Marks pos as constructed and advances size_ over every constructed
+  // position that follows it. Whichever thread marks the lowest unpublished
+  // position moves size_ past all the others.
+  void _publish(size_type pos) {
+    _cell(pos).ready.store(true);
+    auto n = size_.load();
+    while (n < claimed_.load() && _cell(n).ready.load()) {
+      if (size_.compare_exchange_weak(n, n + 1)) {
+        ++n;
+      }
+    }
+  }
+
+  // Takes the shard from bits the index's own probing barely uses.
+  size_type _shard_of(std::size_t hash) const noexcept {
+    auto m = static_cast<std::uint64_t>(hash) * 0x9E3779B97F4A7C15ull;
+    return static_cast<size_type>(m >> 32) & shard_mask_;
+  }
+
+  // Caller holds s.mutex.
+  template <class K>
+  const size_type* _find(const shard& s, std::size_t hash,
+                         const K& key) const {
+    return s.index.find(hash,
+                        [&](size_type pos) { return eq_(_value(pos), key); });
+  }
+
+  template <class V>
+  bool _push_back(std::size_t hash, V&& value) {
+    auto& s = shards_[_shard_of(hash)];
+    size_type pos;
+    {
+      std::lock_guard<std::mutex> lock(s.mutex);
+      if (_find(s, hash, value) != nullptr) {
+        return false;
+      }
+      pos = _emplace(s, hash, std::forward<V>(value),
+                     std::is_nothrow_constructible<T, V&&>());
+    }
+    _publish(pos);
+    return true;
+  }
+
+  // Copies that may throw are made before anything is claimed.
+  template <class V>
+  size_type _emplace(shard& s, std::size_t hash, V&& value, std::false_type) {
+    T tmp(std::forward<V>(value));
+    return _emplace(s, hash, std::move(tmp), std::true_type());
+  }
+
+  // The entry is indexed under npos first, so an allocation failure in the
+  // index or the store leaves nothing behind.
+  template <class V>
+  size_type _emplace(shard& s, std::size_t hash, V&& value, std::true_type) {
+    s.index.insert(hash, npos);
+    size_type pos;
+    try {
+      pos = _claim();
+    } catch (...) {
+      s.index.erase(hash, npos);
+      throw;
+    }
+    alloc_traits::construct(alloc_, &_value(pos), std::forward<V>(value));
+    s.index.relocate(hash, npos, pos);
+    return pos;
+  }
+
+  Allocator alloc_;
+  std::deque<shard, shard_allocator> shards_;
+  size_type shard_mask_ = 0;
+  std::atomic<cell*> segments_[max_segments];
+  std::atomic<size_type> claimed_{0};
+  std::atomic<size_type> size_{0};
+  Hash hash_;
+  KeyEqual eq_;
+};
+
+#if __cplusplus < 201703L
+template <class T, class Hash, class KeyEqual, class Allocator,
+          class IndexPolicy>
+constexpr typename concurrent_vector_of_unique<T, Hash, KeyEqual, Allocator,
+                                               IndexPolicy>::size_type
+    concurrent_vector_of_unique<T, Hash, KeyEqual, Allocator,
+                                IndexPolicy>::npos;
+#endif
+
+}  // namespace containerofunique
@@ -0,0 +1,672 @@
+#pragma once
+
+#include <algorithm>  // For std::copy_n, std::fill_n, std::max, std::min
+#include <cstddef>    // For std::size_t
+#include <cstdint>    // For std::uint32_t, std::uint64_t
+#include <memory>     // For std::allocator, std::allocator_traits
+#include <type_traits>
+#include <utility>  // For std::swap
+
+// Group probing uses AVX2 or SSE2 when the target has them. Defining
+// CONTAINEROFUNIQUE_NO_SIMD selects the portable 8-byte implementation.
+#if !defined(CONTAINEROFUNIQUE_NO_SIMD)
+#if defined(__AVX2__)
+#define CONTAINEROFUNIQUE_AVX2 1
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CONTAINEROFUNIQUE_SSE2 1
+#include <emmintrin.h>
+#endif
+#endif
+
+// Hint to start loading the cache line at p ahead of a read.
+#if defined(__GNUC__) || defined(__clang__)
+#define CONTAINEROFUNIQUE_PREFETCH(p) __builtin_prefetch(p)
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#define CONTAINEROFUNIQUE_PREFETCH(p) \
+  _mm_prefetch(reinterpret_cast<const char*>(p), _MM_HINT_T0)
+#else
+#define CONTAINEROFUNIQUE_PREFETCH(p) static_cast<void>(p)
+#endif
+
+namespace containerofunique {
+namespace detail {
+
+// Index entry handed from one index to another by extract and insert when
+// entries own no memory: the hash, passed alongside, is all there is to
+// carry.
+struct index_entry {};
+
+// Control bytes of a flat_hash_index slot: empty, deleted (a tombstone that
+// keeps probe sequences intact), or full, in which case the byte holds the
+// low 7 bits of the entry's mixed hash.
+using ctrl_t = signed char;
+constexpr ctrl_t ctrl_empty = -128;
+constexpr ctrl_t ctrl_deleted = -2;
+
+// Both are only called with x != 0.
+inline int count_leading_zeros(std::uint64_t x) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_clzll(x);
+#else
+  int n = 0;
+  for (; (x & (std::uint64_t{1} << 63)) == 0; x <<= 1) {
+    ++n;
+  }
+  return n;
+#endif
+}
+
+inline int count_trailing_zeros(std::uint64_t x) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_ctzll(x);
+#else
+  int n = 0;
+  for (; (x & 1) == 0; x >>= 1) {
+    ++n;
+  }
+  return n;
+#endif
+}
+
+// Set of matching slots within a group, one bit (or one byte, for the
+// portable group) per slot.
+template <class Word, int Width, int Shift>
+class group_mask {
+ public:
+  explicit group_mask(Word mask) noexcept : mask_(mask) {}
+
+  explicit operator bool() const noexcept { return mask_ != 0; }
+  std::size_t lowest() const noexcept {
+    return static_cast<std::size_t>(count_trailing_zeros(mask_)) >> Shift;
+  }
+  // Slots before the first / after the last match in a group of Width.
+  std::size_t trailing_zeros() const noexcept { return lowest(); }
+  std::size_t leading_zeros() const noexcept {
+    constexpr int bits = Width << Shift;
+    return static_cast<std::size_t>(count_leading_zeros(mask_) - (64 - bits)) >>
+           Shift;
+  }
+  void clear_lowest() noexcept { mask_ &= mask_ - 1; }
+
+ private:
+  Word mask_;
+};
+
+#if defined(CONTAINEROFUNIQUE_AVX2)
+struct ctrl_group {
+  static constexpr std::size_t width = 32;
+  using mask_type = group_mask<std::uint32_t, 32, 0>;
+
+  explicit ctrl_group(const ctrl_t* p) noexcept
+      : ctrl_(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p))) {}
+
+  mask_type match(ctrl_t h2) const noexcept {
+    return to_mask(_mm256_cmpeq_epi8(ctrl_, _mm256_set1_epi8(h2)));
+  }
+  mask_type match_empty() const noexcept { return match(ctrl_empty); }
+  // Empty and deleted are the only negative control bytes.
+  mask_type match_free() const noexcept {
+    return to_mask(_mm256_cmpgt_epi8(_mm256_setzero_si256(), ctrl_));
+  }
+
+ private:
+  static mask_type to_mask(__m256i v) noexcept {
+    return mask_type(static_cast<std::uint32_t>(_mm256_movemask_epi8(v)));
+  }
+
+  __m256i ctrl_;
+};
+#elif defined(CONTAINEROFUNIQUE_SSE2)
+struct ctrl_group {
+  static constexpr std::size_t width = 16;
+  using mask_type = group_mask<std::uint32_t, 16, 0>;
+
+  explicit ctrl_group(const ctrl_t* p) noexcept
+      : ctrl_(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))) {}
+
+  mask_type match(ctrl_t h2) const noexcept {
+    return to_mask(_mm_cmpeq_epi8(ctrl_, _mm_set1_epi8(h2)));
+  }
+  mask_type match_empty() const noexcept { return match(ctrl_empty); }
+  // Empty and deleted are the only negative control bytes.
+  mask_type match_free() const noexcept {
+    return to_mask(_mm_cmpgt_epi8(_mm_setzero_si128(), ctrl_));
+  }
+
+ private:
+  static mask_type to_mask(__m128i v) noexcept {
+    return mask_type(static_cast<std::uint32_t>(_mm_movemask_epi8(v)));
+  }
+
+  __m128i ctrl_;
+};
+#else
+// Portable group: eight control bytes packed into a word, matched with the
+// usual has-zero-byte bit tricks. match may report false positives next to
+// a true match; callers compare the stored hash anyway.
+struct ctrl_group {
+  static constexpr std::size_t width = 8;
+  using mask_type = group_mask<std::uint64_t, 8, 3>;
+
+  explicit ctrl_group(const ctrl_t* p) noexcept : ctrl_(0) {
+    for (std::size_t i = 0; i < width; ++i) {
+      ctrl_ |= static_cast<std::uint64_t>(static_cast<unsigned char>(p[i]))
+               << (8 * i);
+    }
+  }
+
+  mask_type match(ctrl_t h2) const noexcept {
+    auto x = ctrl_ ^ (lsbs * static_cast<unsigned char>(h2));
+    return mask_type((x - lsbs) & ~x & msbs);
+  }
+  // Empty is the only control byte with bit 7 set and bit 1 clear.
+  mask_type match_empty() const noexcept {
+    return mask_type(ctrl_ & (~ctrl_ << 6) & msbs);
+  }
+  mask_type match_free() const noexcept { return mask_type(ctrl_ & msbs); }
+
+ private:
+  static constexpr std::uint64_t lsbs = 0x0101010101010101ull;
+  static constexpr std::uint64_t msbs = 0x8080808080808080ull;
+
+  std::uint64_t ctrl_;
+};
+#endif
+
+// Spreads weak hashes, such as the identity hash of integers, over all bits
+// before they pick a group and a control byte.
+inline std::size_t mix_hash(std::size_t h) noexcept {
+  auto m = static_cast<std::uint64_t>(h) * 0x9E3779B97F4A7C15ull;
+  return static_cast<std::size_t>(m ^ (m >> 32));
+}
+
+// Open-addressing hash index over the positions of a sequence container,
+// with the same interface as node_hash_index.
+//
+// Entries (hash, position) live in one flat array next to an array of
+// control bytes, Swiss-table style: a probe loads a whole group of control
+// bytes and compares them against the hash's 7-bit tag in a few SIMD
+// instructions, so inserts and lookups allocate nothing and touch one or two
+// cache lines in the common case. The table is a power of two no smaller
+// than a group and keeps at least one empty slot so probes terminate.
+template <class SizeType, class Allocator = std::allocator<SizeType>>
+class flat_hash_index {
+ public:
+  using size_type = SizeType;
+
+  flat_hash_index() noexcept(noexcept(Allocator())) = default;
+
+  explicit flat_hash_index(const Allocator& alloc) noexcept
+      : alloc_(alloc) {}
+
+  flat_hash_index(const flat_hash_index& other)
+      : flat_hash_index(other,
+                        SlotTraits::select_on_container_copy_construction(
+                            other.alloc_)) {}
+
+  flat_hash_index(const flat_hash_index& other, const Allocator& alloc)
+      : alloc_(alloc), max_load_(other.max_load_) {
+    copy_from(other);
+  }
+
+  flat_hash_index(flat_hash_index&& other) noexcept
+      : alloc_(std::move(other.alloc_)) {
+    steal(other);
+  }
+
+  flat_hash_index(flat_hash_index&& other, const Allocator& alloc)
+      : alloc_(alloc), max_load_(other.max_load_) {
+    if (alloc_ == other.alloc_) {
+      steal(other);
+    } else {
+      copy_from(other);
+    }
+  }
+
+  flat_hash_index& operator=(const flat_hash_index& other) {
+    if (this != &other) {
+      copy_assign_alloc(other, typename SlotTraits::
+                                   propagate_on_container_copy_assignment());
+      flat_hash_index tmp(other, alloc_);
+      swap_storage(tmp);
+    }
+    return *this;
+  }
+
+  flat_hash_index& operator=(flat_hash_index&& other) noexcept(
+      SlotTraits::propagate_on_container_move_assignment::value ||
+      SlotTraits::is_always_equal::value) {
+    if (this != &other) {
+      move_assign(other, typename SlotTraits::
+                             propagate_on_container_move_assignment());
+    }
+    return *this;
+  }
+
+  ~flat_hash_index() { release(); }
+
+  // Returns a pointer to the position of the matching entry, or nullptr.
+  template <class Pred>
+  const size_type* find(std::size_t hash, Pred matches) const {
+    auto i = find_slot(hash, matches);
+    return i == npos ? nullptr : &slots_[i].pos;
+  }
+
+  // Starts loading the control bytes and slots a lookup of hash reads
+  // first, so that lookups of a batch of hashes can overlap their misses.
+  void prefetch(std::size_t hash) const noexcept {
+    if (capacity_ == 0) {
+      return;
+    }
+    auto offset = (mix_hash(hash) >> 7) & mask();
+    CONTAINEROFUNIQUE_PREFETCH(ctrl_ + offset);
+    CONTAINEROFUNIQUE_PREFETCH(slots_ + offset);
+  }
+
+  // Returns the hash of the element at pos, which this index obtains by
+  // calling compute().
+  template <class F>
+  std::size_t hash_at(size_type, F compute) const {
+    return compute();
+  }
+
+  void insert(std::size_t hash, size_type pos) {
+    auto mixed = mix_hash(hash);
+    if (growth_left_ == 0) {
+      auto i = capacity_ == 0 ? 0 : find_free(mixed);
+      if (capacity_ == 0 || ctrl_[i] == ctrl_empty) {
+        // A table clogged with tombstones is cleaned up in place, so a
+        // steady stream of erases and inserts never allocates.
+        if (capacity_ != 0 && size_ * 8 <= growth_for(capacity_) * 7) {
+          drop_deleted();
+        } else {
+          resize(capacity_for(size_ + size_ / 2 + 1));
+        }
+      }
+    }
+    auto i = find_free(mixed);
+    if (ctrl_[i] == ctrl_empty) {
+      --growth_left_;
+    }
+    set_ctrl(i, tag(mixed));
+    slots_[i].hash = hash;
+    slots_[i].pos = pos;
+    ++size_;
+  }
+
+  void erase(std::size_t hash, size_type pos) {
+    auto i = locate(hash, pos);
+    if (i != npos) {
+      erase_slot(i);
+    }
+  }
+
+  // Moving entries between tables: extract removes the entry for (hash, pos)
+  // and insert adds it back, at position pos, to this or another table.
+  using entry_type = index_entry;
+
+  entry_type extract(std::size_t hash, size_type pos) {
+    erase(hash, pos);
+    return entry_type();
+  }
+
+  void insert(entry_type&&, std::size_t hash, size_type pos) {
+    insert(hash, pos);
+  }
+
+  // Points the entry for (hash, from) at position to instead.
+  void relocate(std::size_t hash, size_type from, size_type to) {
+    auto i = locate(hash, from);
+    if (i != npos) {
+      slots_[i].pos = to;
+    }
+  }
+
+  // Walks every entry once. f(pos) may rewrite pos in place and returns false
+  // to drop the entry.
+  template <class F>
+  void remap(F f) {
+    for (std::size_t i = 0; i < capacity_; ++i) {
+      if (ctrl_[i] >= 0 && !f(slots_[i].pos)) {
+        erase_slot(i);
+      }
+    }
+  }
+
+  // Calls f(hash) for every entry.
+  template <class F>
+  void for_each_hash(F f) const {
+    for (std::size_t i = 0; i < capacity_; ++i) {
+      if (ctrl_[i] >= 0) {
+        f(slots_[i].hash);
+      }
+    }
+  }
+
+  void clear() noexcept {
+    if (capacity_ != 0) {
+      std::fill_n(ctrl_, capacity_ + ctrl_group::width, ctrl_empty);
+    }
+    size_ = 0;
+    growth_left_ = growth_for(capacity_);
+  }
+
+  bool empty() const noexcept { return size_ == 0; }
+  size_type size() const noexcept { return size_; }
+
+  void swap(flat_hash_index& other) noexcept {
+    swap_storage(other);
+    swap_alloc(other, typename SlotTraits::propagate_on_container_swap());
+  }
+
+  // Bucket interface. Every slot counts as a bucket. The load factor is
+  // capped at 7/8, since open addressing needs free slots to stop probes.
+  size_type bucket_count() const noexcept { return capacity_; }
+  float load_factor() const noexcept {
+    return capacity_ == 0 ? 0.0f
+                          : static_cast<float>(size_) /
+                                static_cast<float>(capacity_);
+  }
+  float max_load_factor() const noexcept { return max_load_; }
+  void max_load_factor(float ml) {
+    max_load_ = ml < max_max_load ? ml : max_max_load;
+    rehash(0);
+  }
+  void rehash(size_type count) {
+    auto needed = std::max<std::size_t>(count, capacity_for(size_));
+    if (needed == 0 && size_ == 0) {
+      release();
+      return;
+    }
+    resize(capacity_for_buckets(needed));
+  }
+  void reserve(size_type count) {
+    if (count > size_ + growth_left_) {
+      resize(capacity_for(count));
+    }
+  }
+
+ private:
+  struct slot {
+    std::size_t hash;
+    size_type pos;
+  };
+
+  using SlotAllocator =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<slot>;
+  using SlotTraits = std::allocator_traits<SlotAllocator>;
+  using CtrlAllocator =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<ctrl_t>;
+  using CtrlTraits = std::allocator_traits<CtrlAllocator>;
+
+  static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+  static constexpr float max_max_load = 0.875f;
+
+  static ctrl_t tag(std::size_t mixed) noexcept {
+    return static_cast<ctrl_t>(mixed & 0x7F);
+  }
+
+  std::size_t mask() const noexcept { return capacity_ - 1; }
+
+  // Entries a table of capacity slots may hold before it must grow.
+  std::size_t growth_for(std::size_t capacity) const noexcept {
+    if (capacity == 0) {
+      return 0;
+    }
+    auto growth = static_cast<std::size_t>(static_cast<float>(capacity) *
+                                           max_load_);
+    return std::min(growth, capacity - 1);
+  }
+
+  // Smallest capacity of at least buckets slots the table supports.
+  static std::size_t capacity_for_buckets(std::size_t buckets) noexcept {
+    std::size_t capacity = ctrl_group::width;
+    while (capacity < buckets) {
+      capacity *= 2;
+    }
+    return capacity;
+  }
+
+  // Smallest capacity that holds count entries, or 0 for none.
+  std::size_t capacity_for(std::size_t count) const noexcept {
+    if (count == 0) {
+      return 0;
+    }
+    std::size_t capacity = ctrl_group::width;
+    while (growth_for(capacity) < count) {
+      capacity *= 2;
+    }
+    return capacity;
+  }
+
+  // Control bytes are followed by a copy of the first group, so a group
+  // load starting anywhere in the table never wraps.
+  void set_ctrl(std::size_t i, ctrl_t c) noexcept {
+    ctrl_[i] = c;
+    if (i < ctrl_group::width) {
+      ctrl_[capacity_ + i] = c;
+    }
+  }
+
+  std::size_t find_free(std::size_t mixed) const noexcept {
+    std::size_t offset = (mixed >> 7) & mask();
+    for (std::size_t step = ctrl_group::width;; step += ctrl_group::width) {
+      auto m = ctrl_group(ctrl_ + offset).match_free();
+      if (m) {
+        return (offset + m.lowest()) & mask();
+      }
+      offset = (offset + step) & mask();
+    }
+  }
+
+  // A slot that no probe can have seen in a group without empties goes
+  // straight back to empty; otherwise it becomes a tombstone.
+  void erase_slot(std::size_t i) noexcept {
+    auto empty_after = ctrl_group(ctrl_ + i).match_empty();
+    auto empty_before =
+        ctrl_group(ctrl_ + ((i - ctrl_group::width) & mask())).match_empty();
+    bool was_never_full = empty_before && empty_after &&
+                          empty_after.trailing_zeros() +
+                                  empty_before.leading_zeros() <
+                              ctrl_group::width;
+    if (was_never_full) {
+      set_ctrl(i, ctrl_empty);
+      ++growth_left_;
+    } else {
+      set_ctrl(i, ctrl_deleted);
+    }
+    --size_;
+  }
+
+  // Rehashes in place, turning every tombstone back into an empty slot.
+  // Entries that stay within their first reachable group are left alone.
+  void drop_deleted() noexcept {
+    for (std::size_t i = 0; i < capacity_; ++i) {
+      ctrl_[i] = ctrl_[i] >= 0 ? ctrl_deleted : ctrl_empty;
+    }
+    std::copy_n(ctrl_, ctrl_group::width, ctrl_ + capacity_);
+    for (std::size_t i = 0; i < capacity_; ++i) {
+      if (ctrl_[i] != ctrl_deleted) {
+        continue;
+      }
+      auto mixed = mix_hash(slots_[i].hash);
+      auto start = (mixed >> 7) & mask();
+      auto target = find_free(mixed);
+      auto probe_index = [this, start](std::size_t pos) {
+        return ((pos - start) & mask()) / ctrl_group::width;
+      };
+      if (probe_index(target) == probe_index(i)) {
+        set_ctrl(i, tag(mixed));
+      } else if (ctrl_[target] == ctrl_empty) {
+        set_ctrl(target, tag(mixed));
+        slots_[target] = slots_[i];
+        set_ctrl(i, ctrl_empty);
+      } else {
+        // The target still holds an entry waiting to be placed: swap it in
+        // and process slot i again.
+        set_ctrl(target, tag(mixed));
+        std::swap(slots_[i], slots_[target]);
+        --i;
+      }
+    }
+    growth_left_ = growth_for(capacity_) - size_;
+  }
+
+  template <class Pred>
+  std::size_t find_slot(std::size_t hash, Pred matches) const {
+    if (capacity_ == 0) {
+      return npos;
+    }
+    auto mixed = mix_hash(hash);
+    auto h2 = tag(mixed);
+    std::size_t offset = (mixed >> 7) & mask();
+    for (std::size_t step = ctrl_group::width;; step += ctrl_group::width) {
+      ctrl_group g(ctrl_ + offset);
+      for (auto m = g.match(h2); m; m.clear_lowest()) {
+        auto i = (offset + m.lowest()) & mask();
+        if (slots_[i].hash == hash && matches(slots_[i].pos)) {
+          return i;
+        }
+      }
+      if (g.match_empty()) {
+        return npos;
+      }
+      offset = (offset + step) & mask();
+    }
+  }
+
+  std::size_t locate(std::size_t hash, size_type pos) const {
+    return find_slot(hash,
+                     [pos](size_type candidate) { return candidate == pos; });
+  }
+
+  // Allocates an empty table; only called on an index that owns no storage.
+  void allocate(std::size_t capacity) {
+    CtrlAllocator ctrl_alloc(alloc_);
+    ctrl_ = CtrlTraits::allocate(ctrl_alloc, capacity + ctrl_group::width);
+    try {
+      slots_ = SlotTraits::allocate(alloc_, capacity);
+    } catch (...) {
+      CtrlTraits::deallocate(ctrl_alloc, ctrl_, capacity + ctrl_group::width);
+      ctrl_ = nullptr;
+      throw;
+    }
+    std::fill_n(ctrl_, capacity + ctrl_group::width, ctrl_empty);
+    capacity_ = capacity;
+    size_ = 0;
+    growth_left_ = growth_for(capacity);
+  }
+
+  void release() noexcept {
+    if (capacity_ != 0) {
+      CtrlAllocator ctrl_alloc(alloc_);
+      CtrlTraits::deallocate(ctrl_alloc, ctrl_, capacity_ + ctrl_group::width);
+      SlotTraits::deallocate(alloc_, slots_, capacity_);
+    }
+    ctrl_ = nullptr;
+    slots_ = nullptr;
+    capacity_ = 0;
+    size_ = 0;
+    growth_left_ = 0;
+  }
+
+  // Rebuilds the table with new_capacity slots, dropping tombstones. The
+  // stored hashes are reused, so no element is rehashed.
+  void resize(std::size_t new_capacity) {
+    flat_hash_index fresh(alloc_);
+    fresh.max_load_ = max_load_;
+    fresh.allocate(new_capacity);
+    for (std::size_t i = 0; i < capacity_; ++i) {
+      if (ctrl_[i] >= 0) {
+        auto mixed = mix_hash(slots_[i].hash);
+        auto j = fresh.find_free(mixed);
+        fresh.set_ctrl(j, tag(mixed));
+        fresh.slots_[j] = slots_[i];
+      }
+    }
+    fresh.size_ = size_;
+    fresh.growth_left_ -= size_;
+    swap_storage(fresh);
+  }
+
+  void swap_storage(flat_hash_index& other) noexcept {
+    using std::swap;
+    swap(ctrl_, other.ctrl_);
+    swap(slots_, other.slots_);
+    swap(capacity_, other.capacity_);
+    swap(size_, other.size_);
+    swap(growth_left_, other.growth_left_);
+    swap(max_load_, other.max_load_);
+  }
+
+  void swap_alloc(flat_hash_index& other, std::true_type) noexcept {
+    using std::swap;
+    swap(alloc_, other.alloc_);
+  }
+  void swap_alloc(flat_hash_index&, std::false_type) noexcept {}
+
+  // Storage is released before the allocator changes, so it is always
+  // returned to the allocator it came from.
+  void copy_assign_alloc(const flat_hash_index& other, std::true_type) {
+    if (alloc_ != other.alloc_) {
+      release();
+    }
+    alloc_ = other.alloc_;
+  }
+  void copy_assign_alloc(const flat_hash_index&, std::false_type) {}
+
+  void move_assign(flat_hash_index& other, std::true_type) noexcept {
+    release();
+    alloc_ = std::move(other.alloc_);
+    steal(other);
+  }
+
+  void move_assign(flat_hash_index& other, std::false_type) {
+    if (alloc_ == other.alloc_) {
+      release();
+      steal(other);
+    } else {
+      flat_hash_index tmp(other, alloc_);
+      swap_storage(tmp);
+    }
+  }
+
+  void copy_from(const flat_hash_index& other) {
+    if (other.capacity_ == 0) {
+      return;
+    }
+    allocate(other.capacity_);
+    std::copy_n(other.ctrl_, capacity_ + ctrl_group::width, ctrl_);
+    std::copy_n(other.slots_, capacity_, slots_);
+    size_ = other.size_;
+    growth_left_ = other.growth_left_;
+  }
+
+  void steal(flat_hash_index& other) noexcept {
+    ctrl_ = other.ctrl_;
+    slots_ = other.slots_;
+    capacity_ = other.capacity_;
+    size_ = other.size_;
+    growth_left_ = other.growth_left_;
+    max_load_ = other.max_load_;
+    other.ctrl_ = nullptr;
+    other.slots_ = nullptr;
+    other.capacity_ = 0;
+    other.size_ = 0;
+    other.growth_left_ = 0;
+  }
+
+  SlotAllocator alloc_;
+  ctrl_t* ctrl_ = nullptr;
+  slot* slots_ = nullptr;
+  std::size_t capacity_ = 0;
+  std::size_t size_ = 0;
+  std::size_t growth_left_ = 0;
+  float max_load_ = max_max_load;
+};
+
+}  // namespace detail
+}  // namespace containerofunique
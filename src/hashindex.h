@@ -0,0 +1,746 @@
+#pragma once
+
+#include <algorithm>  // For std::max
+#include <atomic>
+#include <cstddef>  // For std::size_t
+#include <cstdint>  // For std::uint32_t, std::uint64_t
+#include <deque>
+#include <functional>  // For std::equal_to
+#include <memory>      // For std::allocator, std::allocator_traits
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>  // For std::forward, std::move, std::swap
+#include <vector>
+
+#include "flathashindex.h"
+
+namespace containerofunique {
+
+template <class T, class Hash, class KeyEqual, class Allocator,
+          class IndexPolicy>
+class vector_of_unique;
+template <class T, class Hash, class KeyEqual, class Allocator,
+          class IndexPolicy>
+class deque_of_unique;
+
+// Lookup counts of a bloom_filter index: how many lookups reached the index,
+// and how many of those the filter answered as definite misses without
+// probing the table.
+struct bloom_stats {
+  std::size_t lookups = 0;
+  std::size_t filtered = 0;
+};
+
+namespace detail {
+
+// Hasher for keys that already are hash values.
+struct identity_hash {
+  std::size_t operator()(std::size_t h) const noexcept { return h; }
+};
+
+// Hash index over the positions of a sequence container.
+//
+// Each entry holds an element's hash and its position in the sequence; the
+// elements themselves are stored only once, in the sequence. Lookups take the
+// probe key's hash plus a predicate that compares the element at a candidate
+// position with the probe key.
+template <class SizeType, class Allocator = std::allocator<SizeType>>
+class node_hash_index {
+  using EntryAllocator = typename std::allocator_traits<Allocator>::
+      template rebind_alloc<std::pair<const std::size_t, SizeType>>;
+  using MapType = std::unordered_multimap<std::size_t, SizeType, identity_hash,
+                                          std::equal_to<std::size_t>,
+                                          EntryAllocator>;
+
+ public:
+  using size_type = SizeType;
+
+  node_hash_index() = default;
+
+  explicit node_hash_index(const Allocator& alloc)
+      : map_(EntryAllocator(alloc)) {}
+
+  node_hash_index(const node_hash_index& other, const Allocator& alloc)
+      : map_(other.map_, EntryAllocator(alloc)) {}
+
+  node_hash_index(node_hash_index&& other, const Allocator& alloc)
+      : map_(std::move(other.map_), EntryAllocator(alloc)) {}
+
+  // Returns a pointer to the position of the matching entry, or nullptr.
+  template <class Pred>
+  const size_type* find(std::size_t hash, Pred matches) const {
+    auto range = map_.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (matches(it->second)) {
+        return &it->second;
+      }
+    }
+    return nullptr;
+  }
+
+  void insert(std::size_t hash, size_type pos) { map_.emplace(hash, pos); }
+
+  // The bucket array of std::unordered_multimap is out of reach, so there is
+  // nothing to load ahead of a lookup.
+  void prefetch(std::size_t) const noexcept {}
+
+  // Returns the hash of the element at pos, which this index obtains by
+  // calling compute().
+  template <class F>
+  std::size_t hash_at(size_type, F compute) const {
+    return compute();
+  }
+
+  void erase(std::size_t hash, size_type pos) {
+    auto it = locate(hash, pos);
+    if (it != map_.end()) {
+      map_.erase(it);
+    }
+  }
+
+  // Moving entries between indexes: extract removes the entry for (hash,
+  // pos) and insert adds it back, at position pos, to this or another
+  // index. Since C++17 the entry is the map node itself, which insert reuses
+  // instead of allocating one when both maps' allocators compare equal.
+#if __cplusplus >= 201703L
+  using entry_type = typename MapType::node_type;
+
+  entry_type extract(std::size_t hash, size_type pos) {
+    auto it = locate(hash, pos);
+    return it == map_.end() ? entry_type() : map_.extract(it);
+  }
+
+  void insert(entry_type&& entry, std::size_t hash, size_type pos) {
+    if (entry.empty() || entry.get_allocator() != map_.get_allocator()) {
+      insert(hash, pos);
+      return;
+    }
+    entry.mapped() = pos;
+    map_.insert(std::move(entry));
+  }
+#else
+  using entry_type = index_entry;
+
+  entry_type extract(std::size_t hash, size_type pos) {
+    erase(hash, pos);
+    return entry_type();
+  }
+
+  void insert(entry_type&&, std::size_t hash, size_type pos) {
+    insert(hash, pos);
+  }
+#endif
+
+  // Points the entry for (hash, from) at position to instead.
+  void relocate(std::size_t hash, size_type from, size_type to) {
+    auto it = locate(hash, from);
+    if (it != map_.end()) {
+      it->second = to;
+    }
+  }
+
+  // Walks every entry once. f(pos) may rewrite pos in place and returns false
+  // to drop the entry.
+  template <class F>
+  void remap(F f) {
+    for (auto it = map_.begin(); it != map_.end();) {
+      if (f(it->second)) {
+        ++it;
+      } else {
+        it = map_.erase(it);
+      }
+    }
+  }
+
+  // Calls f(hash) for every entry.
+  template <class F>
+  void for_each_hash(F f) const {
+    for (const auto& entry : map_) {
+      f(entry.first);
+    }
+  }
+
+  void clear() noexcept { map_.clear(); }
+  bool empty() const noexcept { return map_.empty(); }
+  size_type size() const noexcept { return map_.size(); }
+
+  void swap(node_hash_index& other) noexcept { map_.swap(other.map_); }
+
+  // Bucket interface
+  size_type bucket_count() const noexcept { return map_.bucket_count(); }
+  float load_factor() const noexcept { return map_.load_factor(); }
+  float max_load_factor() const noexcept { return map_.max_load_factor(); }
+  // std::unordered_multimap may defer the rehash a lower limit calls for, so
+  // it is applied straight away.
+  void max_load_factor(float ml) {
+    map_.max_load_factor(ml);
+    map_.rehash(0);
+  }
+  void rehash(size_type count) { map_.rehash(count); }
+  void reserve(size_type count) { map_.reserve(count); }
+
+ private:
+  typename MapType::iterator locate(std::size_t hash, size_type pos) {
+    auto range = map_.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second == pos) {
+        return it;
+      }
+    }
+    return map_.end();
+  }
+
+  MapType map_;
+};
+
+// Wraps another index and also remembers each entry's hash by position, so
+// containers never call Hash again on an element they already hold. The
+// positions an index sees form a contiguous range (possibly with holes),
+// which is stored as a deque of hashes starting at origin_.
+template <class Index, class Allocator>
+class cached_hash_index : public Index {
+ public:
+  using size_type = typename Index::size_type;
+
+  cached_hash_index() = default;
+
+  explicit cached_hash_index(const Allocator& alloc)
+      : Index(alloc), hashes_(HashAllocator(alloc)) {}
+
+  cached_hash_index(const cached_hash_index& other, const Allocator& alloc)
+      : Index(other, alloc),
+        hashes_(other.hashes_, HashAllocator(alloc)),
+        origin_(other.origin_) {}
+
+  cached_hash_index(cached_hash_index&& other, const Allocator& alloc)
+      : Index(std::move(other), alloc),
+        hashes_(std::move(other.hashes_), HashAllocator(alloc)),
+        origin_(other.origin_) {}
+
+  template <class F>
+  std::size_t hash_at(size_type pos, F) const {
+    return hashes_[pos - origin_];
+  }
+
+  void insert(std::size_t hash, size_type pos) {
+    Index::insert(hash, pos);
+    store(pos, hash);
+  }
+
+  void erase(std::size_t hash, size_type pos) {
+    Index::erase(hash, pos);
+    forget(pos);
+  }
+
+  using entry_type = typename Index::entry_type;
+
+  entry_type extract(std::size_t hash, size_type pos) {
+    auto entry = Index::extract(hash, pos);
+    forget(pos);
+    return entry;
+  }
+
+  void insert(entry_type&& entry, std::size_t hash, size_type pos) {
+    Index::insert(std::move(entry), hash, pos);
+    store(pos, hash);
+  }
+
+  void relocate(std::size_t hash, size_type from, size_type to) {
+    Index::relocate(hash, from, to);
+    store(to, hash);
+  }
+
+  template <class F>
+  void remap(F f) {
+    std::vector<std::pair<size_type, std::size_t>> moved;
+    moved.reserve(Index::size());
+    Index::remap([&](size_type& pos) {
+      auto hash = hashes_[pos - origin_];
+      if (!f(pos)) {
+        return false;
+      }
+      moved.emplace_back(pos, hash);
+      return true;
+    });
+    hashes_.clear();
+    for (const auto& m : moved) {
+      store(m.first, m.second);
+    }
+  }
+
+  void clear() noexcept {
+    Index::clear();
+    hashes_.clear();
+  }
+
+  void swap(cached_hash_index& other) noexcept {
+    Index::swap(other);
+    hashes_.swap(other.hashes_);
+    std::swap(origin_, other.origin_);
+  }
+
+ private:
+  using HashAllocator = typename std::allocator_traits<
+      Allocator>::template rebind_alloc<std::size_t>;
+
+  // Drops the stored hash of an erased position at either end.
+  void forget(size_type pos) {
+    if (hashes_.empty()) {
+      return;
+    }
+    if (pos == origin_) {
+      hashes_.pop_front();
+      ++origin_;
+    } else if (pos - origin_ == hashes_.size() - 1) {
+      hashes_.pop_back();
+    }
+  }
+
+  // Positions just past either end extend the deque; positions further out
+  // (free slots of a bounded container) leave holes that are filled later.
+  void store(size_type pos, std::size_t hash) {
+    if (hashes_.empty()) {
+      origin_ = pos;
+    }
+    auto offset = pos - origin_;
+    if (offset < hashes_.size()) {
+      hashes_[offset] = hash;
+    } else if (offset < static_cast<size_type>(-1) / 2) {
+      hashes_.resize(offset + 1);
+      hashes_.back() = hash;
+    } else {
+      hashes_.insert(hashes_.begin(), origin_ - pos, 0);
+      origin_ = pos;
+      hashes_.front() = hash;
+    }
+  }
+
+  std::deque<std::size_t, HashAllocator> hashes_;
+  size_type origin_ = 0;
+};
+
+// Counter bumped by const lookups, possibly on several threads at once. It
+// is bumped with a relaxed load and store rather than a read-modify-write,
+// so concurrent lookups may lose counts but never race.
+class relaxed_counter {
+ public:
+  relaxed_counter() = default;
+  relaxed_counter(const relaxed_counter& other) noexcept : n_(other.get()) {}
+  relaxed_counter& operator=(const relaxed_counter& other) noexcept {
+    n_.store(other.get(), std::memory_order_relaxed);
+    return *this;
+  }
+
+  void bump() const noexcept {
+    n_.store(n_.load(std::memory_order_relaxed) + 1,
+             std::memory_order_relaxed);
+  }
+  std::size_t get() const noexcept {
+    return n_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  mutable std::atomic<std::size_t> n_{0};
+};
+
+// Wraps another index behind a split-block Bloom filter over the entries'
+// hashes, so that lookups of absent keys usually return without probing the
+// table. Each hash maps to one 512-bit block and sets one bit in each of its
+// eight words, so a lookup reads a single block.
+//
+// The filter is sized for BitsPerKey bits per entry. Erased entries keep
+// their bits until the filter is rebuilt from the wrapped index's hashes,
+// which happens, at twice the current size, once as many entries have been
+// added since the last rebuild as the filter was sized for.
+template <class Index, class Allocator, std::size_t BitsPerKey>
+class bloom_filter_index : public Index {
+  static_assert(BitsPerKey > 0, "BitsPerKey must be positive");
+
+ public:
+  using size_type = typename Index::size_type;
+
+  bloom_filter_index() = default;
+
+  explicit bloom_filter_index(const Allocator& alloc)
+      : Index(alloc), words_(WordAllocator(alloc)) {}
+
+  bloom_filter_index(const bloom_filter_index& other, const Allocator& alloc)
+      : Index(other, alloc),
+        words_(other.words_, WordAllocator(alloc)),
+        block_count_(other.block_count_),
+        capacity_(other.capacity_),
+        added_(other.added_) {}
+
+  bloom_filter_index(const bloom_filter_index&) = default;
+
+  // A moved-from filter is reset to no blocks, so that it answers lookups
+  // and accepts inserts like a default-constructed one.
+  bloom_filter_index(bloom_filter_index&& other) noexcept(
+      std::is_nothrow_move_constructible<Index>::value)
+      : Index(std::move(other)),
+        words_(std::move(other.words_)),
+        block_count_(other.block_count_),
+        capacity_(other.capacity_),
+        added_(other.added_),
+        lookups_(other.lookups_),
+        filtered_(other.filtered_) {
+    other.reset_filter();
+  }
+
+  bloom_filter_index(bloom_filter_index&& other, const Allocator& alloc)
+      : Index(std::move(other), alloc),
+        words_(std::move(other.words_), WordAllocator(alloc)),
+        block_count_(other.block_count_),
+        capacity_(other.capacity_),
+        added_(other.added_),
+        lookups_(other.lookups_),
+        filtered_(other.filtered_) {
+    other.reset_filter();
+  }
+
+  bloom_filter_index& operator=(const bloom_filter_index&) = default;
+
+  bloom_filter_index& operator=(bloom_filter_index&& other) noexcept(
+      std::is_nothrow_move_assignable<Index>::value &&
+      std::is_nothrow_move_assignable<WordVector>::value) {
+    if (this != &other) {
+      Index::operator=(std::move(other));
+      words_ = std::move(other.words_);
+      block_count_ = other.block_count_;
+      capacity_ = other.capacity_;
+      added_ = other.added_;
+      lookups_ = other.lookups_;
+      filtered_ = other.filtered_;
+      other.reset_filter();
+    }
+    return *this;
+  }
+
+  template <class Pred>
+  const size_type* find(std::size_t hash, Pred matches) const {
+    lookups_.bump();
+    if (!may_contain(hash)) {
+      filtered_.bump();
+      return nullptr;
+    }
+    return Index::find(hash, matches);
+  }
+
+  void prefetch(std::size_t hash) const noexcept {
+    if (block_count_ != 0) {
+      CONTAINEROFUNIQUE_PREFETCH(words_.data() + block_of(mix(hash)));
+    }
+    Index::prefetch(hash);
+  }
+
+  void insert(std::size_t hash, size_type pos) {
+    Index::insert(hash, pos);
+    add(hash);
+  }
+
+  using entry_type = typename Index::entry_type;
+
+  void insert(entry_type&& entry, std::size_t hash, size_type pos) {
+    Index::insert(std::move(entry), hash, pos);
+    add(hash);
+  }
+
+  void clear() noexcept {
+    Index::clear();
+    std::fill(words_.begin(), words_.end(), 0);
+    added_ = 0;
+  }
+
+  void swap(bloom_filter_index& other) noexcept {
+    Index::swap(other);
+    words_.swap(other.words_);
+    std::swap(block_count_, other.block_count_);
+    std::swap(capacity_, other.capacity_);
+    std::swap(added_, other.added_);
+    std::swap(lookups_, other.lookups_);
+    std::swap(filtered_, other.filtered_);
+  }
+
+  // Sizes the filter as well as the table for count entries.
+  void reserve(size_type count) {
+    Index::reserve(count);
+    if (count > capacity_) {
+      rebuild(count);
+    }
+  }
+
+  bloom_stats stats() const noexcept {
+    bloom_stats s;
+    s.lookups = lookups_.get();
+    s.filtered = filtered_.get();
+    return s;
+  }
+
+ private:
+  using WordAllocator = typename std::allocator_traits<
+      Allocator>::template rebind_alloc<std::uint64_t>;
+  using WordVector = std::vector<std::uint64_t, WordAllocator>;
+
+  static constexpr std::size_t words_per_block = 8;
+  static constexpr std::size_t bits_per_block = 64 * words_per_block;
+  static constexpr std::size_t min_capacity = 64;
+
+  void reset_filter() noexcept {
+    words_.clear();
+    block_count_ = 0;
+    capacity_ = 0;
+    added_ = 0;
+  }
+
+  static std::uint64_t mix(std::size_t hash) noexcept {
+    auto m = static_cast<std::uint64_t>(hash) * 0x9E3779B97F4A7C15ull;
+    return m ^ (m >> 32);
+  }
+
+  // Bit of word w that a mixed hash sets, from its low 32 bits.
+  static std::uint64_t bit(std::uint64_t mixed, std::size_t w) noexcept {
+    static constexpr std::uint64_t salts[words_per_block] = {
+        0x47b6137b44974d91ull, 0x8824ad5ba2b7289dull, 0x705495c72df1424bull,
+        0x9efc49475c6bfb31ull, 0x3b8d2d5f1e8d7a6bull, 0xc6a4a7935bd1e995ull,
+        0x2545f4914f6cdd1dull, 0x5851f42d4c957f2dull};
+    auto low = static_cast<std::uint32_t>(mixed);
+    return std::uint64_t{1} << ((low * salts[w]) >> 58);
+  }
+
+  // First word of the block a mixed hash maps to, from its high 32 bits.
+  std::size_t block_of(std::uint64_t mixed) const noexcept {
+    return static_cast<std::size_t>(((mixed >> 32) * block_count_) >> 32) *
+           words_per_block;
+  }
+
+  bool may_contain(std::size_t hash) const noexcept {
+    if (block_count_ == 0) {
+      return false;
+    }
+    auto mixed = mix(hash);
+    const auto* block = words_.data() + block_of(mixed);
+    // Checking all eight words without branching beats stopping at the
+    // first clear bit, which mispredicts about half the time on a miss.
+    std::uint64_t missing = 0;
+    for (std::size_t w = 0; w < words_per_block; ++w) {
+      missing |= ~block[w] & bit(mixed, w);
+    }
+    return missing == 0;
+  }
+
+  void set_bits(WordVector& words, std::size_t hash) const noexcept {
+    auto mixed = mix(hash);
+    auto* block = words.data() + block_of(mixed);
+    for (std::size_t w = 0; w < words_per_block; ++w) {
+      block[w] |= bit(mixed, w);
+    }
+  }
+
+  // Called after hash has been added to the wrapped index.
+  void add(std::size_t hash) {
+    if (added_ < capacity_) {
+      ++added_;
+      set_bits(words_, hash);
+    } else {
+      rebuild(std::max(2 * std::size_t{Index::size()},
+                       std::size_t{min_capacity}));
+    }
+  }
+
+  // Resizes the filter for capacity entries and refills it from the
+  // wrapped index. The new filter is filled before it replaces the old one,
+  // so a failed allocation leaves the old filter valid.
+  void rebuild(std::size_t capacity) {
+    auto blocks = (capacity * BitsPerKey + bits_per_block - 1) / bits_per_block;
+    WordVector words(blocks * words_per_block, 0, words_.get_allocator());
+    block_count_ = blocks;
+    Index::for_each_hash([&](std::size_t h) { set_bits(words, h); });
+    words_.swap(words);
+    capacity_ = capacity;
+    added_ = Index::size();
+  }
+
+  WordVector words_;
+  std::size_t block_count_ = 0;
+  // Entries the filter is sized for, and entries added since it was built.
+  std::size_t capacity_ = 0;
+  std::size_t added_ = 0;
+  relaxed_counter lookups_;
+  relaxed_counter filtered_;
+};
+
+// Read-only, unordered-set-like view of the elements a container has indexed.
+// Iteration walks the container's sequence; lookups go through its index.
+template <class Container>
+class set_view {
+ public:
+  using key_type = typename Container::key_type;
+  using value_type = typename Container::value_type;
+  using hasher = typename Container::hasher;
+  using key_equal = typename Container::key_equal;
+  using size_type = typename Container::size_type;
+  using const_reference = typename Container::const_reference;
+  using const_iterator = typename Container::const_iterator;
+  using iterator = const_iterator;
+
+  explicit set_view(const Container& c) noexcept : c_(&c) {}
+
+  const_iterator begin() const noexcept { return c_->cbegin(); }
+  const_iterator end() const noexcept { return c_->cend(); }
+  const_iterator cbegin() const noexcept { return c_->cbegin(); }
+  const_iterator cend() const noexcept { return c_->cend(); }
+
+  bool empty() const noexcept { return c_->index_.empty(); }
+  size_type size() const noexcept { return c_->index_.size(); }
+
+  template <class K>
+  const_iterator find(const K& key) const {
+    return c_->find(key);
+  }
+
+  template <class K>
+  size_type count(const K& key) const {
+    return c_->find(key) == c_->cend() ? 0 : 1;
+  }
+
+  hasher hash_function() const { return c_->hash_function(); }
+  key_equal key_eq() const { return c_->key_eq(); }
+
+ private:
+  const Container* c_;
+};
+
+// Node handle of vector_of_unique and deque_of_unique, modelled on those of
+// std::unordered_set: extract moves an element out of its container into
+// the handle together with its hash and index entry, and insert moves it
+// into any container with the same node_type without hashing it again.
+// Move-only; a default-constructed or moved-from handle is empty.
+template <class T, class Hash, class Entry>
+class unique_node_handle {
+ public:
+  using value_type = T;
+
+  unique_node_handle() noexcept {}
+
+  unique_node_handle(unique_node_handle&& other) noexcept(
+      std::is_nothrow_move_constructible<T>::value)
+      : hash_(other.hash_), entry_(std::move(other.entry_)) {
+    if (!other.empty_) {
+      ::new (static_cast<void*>(&value_)) T(std::move(other.value_));
+      empty_ = false;
+      other.reset();
+    }
+  }
+
+  unique_node_handle& operator=(unique_node_handle&& other) {
+    if (this != &other) {
+      reset();
+      hash_ = other.hash_;
+      entry_ = std::move(other.entry_);
+      if (!other.empty_) {
+        ::new (static_cast<void*>(&value_)) T(std::move(other.value_));
+        empty_ = false;
+        other.reset();
+      }
+    }
+    return *this;
+  }
+
+  ~unique_node_handle() { reset(); }
+
+  bool empty() const noexcept { return empty_; }
+  explicit operator bool() const noexcept { return !empty_; }
+
+  // Precondition: !empty(). The value may be modified, as long as its hash
+  // and equality stay the same.
+  value_type& value() noexcept { return value_; }
+  const value_type& value() const noexcept { return value_; }
+
+  // Hash of value(), as computed by Hash.
+  std::size_t hash() const noexcept { return hash_; }
+
+  void swap(unique_node_handle& other) {
+    unique_node_handle tmp(std::move(other));
+    other = std::move(*this);
+    *this = std::move(tmp);
+  }
+
+ private:
+  template <class, class, class, class, class>
+  friend class containerofunique::vector_of_unique;
+  template <class, class, class, class, class>
+  friend class containerofunique::deque_of_unique;
+
+  template <class V>
+  unique_node_handle(V&& value, std::size_t hash)
+      : value_(std::forward<V>(value)), hash_(hash), empty_(false) {}
+
+  void reset() noexcept {
+    if (!empty_) {
+      value_.~T();
+      empty_ = true;
+    }
+    entry_ = Entry();
+  }
+
+  union {
+    T value_;
+  };
+  std::size_t hash_ = 0;
+  Entry entry_;
+  bool empty_ = true;
+};
+
+// Result of inserting a node handle, as for std::unordered_set: where the
+// element is, whether it was inserted, and the handle back if it was not.
+template <class Iterator, class NodeType>
+struct node_insert_return {
+  Iterator position;
+  bool inserted;
+  NodeType node;
+};
+
+}  // namespace detail
+
+// Index policies, selecting the hash index a container keeps over the
+// positions of its elements.
+
+// Node-based chained table (std::unordered_multimap). The default.
+struct node_index {
+  template <class SizeType, class Allocator>
+  using type = detail::node_hash_index<SizeType, Allocator>;
+};
+
+// Flat open-addressing table with SIMD group probing. Inserts allocate only
+// when the table grows, and probes usually stay within one cache line.
+struct flat_index {
+  template <class SizeType, class Allocator>
+  using type = detail::flat_hash_index<SizeType, Allocator>;
+};
+
+// Any of the above, plus each element's hash stored by position. Erasing
+// and popping reuse the stored hash instead of calling Hash on the element,
+// which pays off for expensive hashes such as those of long strings, at the
+// cost of one std::size_t per element.
+template <class IndexPolicy = node_index>
+struct cached_hash {
+  template <class SizeType, class Allocator>
+  using type = detail::cached_hash_index<
+      typename IndexPolicy::template type<SizeType, Allocator>, Allocator>;
+};
+
+// Any of the above behind a blocked Bloom filter with BitsPerKey bits per
+// entry (about 1% false positives at 10 once full), so that lookups of
+// absent keys usually skip the table. Containers report its hit rate
+// through prefilter_stats(). Each lookup stores to a shared counter, which
+// costs read-heavy workloads on many threads.
+template <class IndexPolicy = node_index, std::size_t BitsPerKey = 10>
+struct bloom_filter {
+  template <class SizeType, class Allocator>
+  using type = detail::bloom_filter_index<
+      typename IndexPolicy::template type<SizeType, Allocator>, Allocator,
+      BitsPerKey>;
+};
+
+}  // namespace containerofunique
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <algorithm>  // For std::min
+#include <cstddef>    // For std::size_t, std::ptrdiff_t
+#include <cstdint>    // For std::uint64_t
+#include <exception>  // For std::exception_ptr
+#include <iterator>   // For std::distance
+#include <thread>
+#include <vector>
+
+#include "flathashindex.h"
+
+namespace containerofunique {
+namespace detail {
+
+// Runs f(0) ... f(count - 1) on count threads, one of them the caller, and
+// rethrows the first exception any of them threw. If a thread cannot be
+// started, the caller runs the calls that were left without one.
+template <class F>
+void run_parallel(std::size_t count, F f) {
+  std::vector<std::exception_ptr> errors(count);
+  std::vector<std::thread> threads;
+  threads.reserve(count - 1);
+  auto run = [&](std::size_t t) {
+    try {
+      f(t);
+    } catch (...) {
+      errors[t] = std::current_exception();
+    }
+  };
+  std::size_t started = 1;
+  try {
+    for (; started < count; ++started) {
+      threads.emplace_back(run, started);
+    }
+  } catch (...) {
+    // Typically std::system_error once the process is out of threads; the
+    // threads already started must still be joined below.
+  }
+  run(0);
+  for (auto t = started; t < count; ++t) {
+    run(t);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (auto& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+}
+
+// Partition of a hash among count partitions, from bits the index's own
+// probing barely uses.
+inline std::size_t hash_partition(std::size_t hash,
+                                  std::size_t count) noexcept {
+  auto m = static_cast<std::uint64_t>(hash) * 0x9E3779B97F4A7C15ull;
+  return static_cast<std::size_t>(((m >> 32) * count) >> 32);
+}
+
+}  // namespace detail
+
+// Builds a Container (vector_of_unique or deque_of_unique) from a random
+// access range on thread_count threads, 0 meaning one per hardware thread.
+// The result is identical to Container(first, last, alloc): the first
+// occurrence of every value, in input order.
+//
+// Each thread hashes a slice of the input and splits its indices by hash
+// partition. Equal values share a hash and so a partition, so each thread
+// then finds the first occurrences within one partition on its own, by
+// walking that partition's indices in input order. The container is filled
+// from the surviving indices with the precomputed hashes; that last pass is
+// serial but only probes and copies the unique elements. Inputs too small
+// to split are built serially.
+template <class Container, class random_it>
+Container parallel_build(random_it first, random_it last,
+                         std::size_t thread_count = 0,
+                         const typename Container::allocator_type& alloc =
+                             typename Container::allocator_type()) {
+  // Below this many elements per thread, starting threads costs more than
+  // it saves.
+  constexpr std::size_t min_chunk = 1 << 14;
+
+  auto n = static_cast<std::size_t>(std::distance(first, last));
+  if (thread_count == 0) {
+    thread_count = std::thread::hardware_concurrency();
+  }
+  auto parts = std::min<std::size_t>(thread_count, n / min_chunk);
+  if (parts <= 1) {
+    return Container(first, last, alloc);
+  }
+
+  Container result(alloc);
+  auto hash = result.hash_function();
+  auto eq = result.key_eq();
+  auto chunk = (n + parts - 1) / parts;
+
+  // Phase 1: hash every element and split indices by partition. by_part[t]
+  // holds slice t's indices for each partition, in input order.
+  std::vector<std::size_t> hashes(n);
+  std::vector<std::vector<std::vector<std::size_t>>> by_part(
+      parts, std::vector<std::vector<std::size_t>>(parts));
+  detail::run_parallel(parts, [&](std::size_t t) {
+    auto begin = t * chunk;
+    auto end = std::min(n, begin + chunk);
+    auto& lists = by_part[t];
+    for (auto& list : lists) {
+      list.reserve((end - begin) / parts + (end - begin) / parts / 4 + 1);
+    }
+    for (auto i = begin; i < end; ++i) {
+      hashes[i] = hash(first[static_cast<std::ptrdiff_t>(i)]);
+      lists[detail::hash_partition(hashes[i], parts)].push_back(i);
+    }
+  });
+
+  // Phase 2: keep the first occurrence of each value, one partition per
+  // thread. Visiting the slices in order visits each partition in input
+  // order.
+  std::vector<unsigned char> keep(n);
+  detail::run_parallel(parts, [&](std::size_t p) {
+    std::size_t total = 0;
+    for (std::size_t t = 0; t < parts; ++t) {
+      total += by_part[t][p].size();
+    }
+    detail::flat_hash_index<std::size_t> seen;
+    seen.reserve(total);
+    for (std::size_t t = 0; t < parts; ++t) {
+      for (auto i : by_part[t][p]) {
+        const auto& value = first[static_cast<std::ptrdiff_t>(i)];
+        auto found = seen.find(hashes[i], [&](std::size_t j) {
+          return eq(first[static_cast<std::ptrdiff_t>(j)], value);
+        });
+        if (found == nullptr) {
+          seen.insert(hashes[i], i);
+          keep[i] = 1;
+        }
+      }
+    }
+  });
+
+  // Phase 3: assemble in input order.
+  std::size_t unique = 0;
+  for (auto k : keep) {
+    unique += k;
+  }
+  result.reserve(unique);
+  for (std::size_t i = 0; i < n; ++i) {
+    if (keep[i] != 0) {
+      result.insert_with_hash(first[static_cast<std::ptrdiff_t>(i)],
+                              hashes[i]);
+    }
+  }
+  return result;
+}
+
+}  // namespace containerofunique
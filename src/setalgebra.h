@@ -0,0 +1,84 @@
+#pragma once
+
+#include <algorithm>  // For std::sort
+#include <cstddef>    // For std::size_t
+#include <utility>    // For std::pair
+#include <vector>
+
+#include "dequeofunique.h"
+#include "vectorofunique.h"
+
+namespace containerofunique {
+
+// Non-mutating set operations on vector_of_unique and deque_of_unique. lhs
+// and rhs may be different containers of the same T whose Hash and KeyEqual
+// agree. The result has lhs's type and allocator and keeps lhs's order.
+// Hashes computed for a probe are reused to index the result, and only the
+// elements of the smaller operand are hashed to find the common ones.
+
+// Returns the elements of lhs followed by those of rhs that lhs lacks.
+template <class Container, class Other>
+Container set_union(const Container& lhs, const Other& rhs) {
+  // The copy reuses lhs's index as is.
+  Container result(lhs);
+  result.merge_from(rhs);
+  return result;
+}
+
+// Returns the elements of lhs that rhs contains.
+template <class Container, class Other>
+Container set_intersection(const Container& lhs, const Other& rhs) {
+  using size_type = typename Container::size_type;
+  Container result(lhs.get_allocator());
+  auto hash = lhs.hash_function();
+  if (rhs.size() < lhs.size()) {
+    // Probe lhs with rhs's elements, then put the matches back in lhs's
+    // order.
+    std::vector<std::pair<size_type, std::size_t>> found;
+    found.reserve(rhs.size());
+    for (const auto& x : rhs) {
+      auto h = hash(x);
+      auto it = lhs.find_with_hash(x, h);
+      if (it != lhs.cend()) {
+        found.emplace_back(static_cast<size_type>(it - lhs.cbegin()), h);
+      }
+    }
+    std::sort(found.begin(), found.end());
+    result.reserve(found.size());
+    for (const auto& f : found) {
+      result.insert_with_hash(lhs[f.first], f.second);
+    }
+    return result;
+  }
+  result.reserve(lhs.size());
+  for (const auto& x : lhs) {
+    auto h = hash(x);
+    if (rhs.find_with_hash(x, h) != rhs.cend()) {
+      result.insert_with_hash(x, h);
+    }
+  }
+  return result;
+}
+
+// Returns the elements of lhs that rhs does not contain.
+template <class Container, class Other>
+Container set_difference(const Container& lhs, const Other& rhs) {
+  if (rhs.size() < lhs.size()) {
+    // Copy lhs with its index and probe it with rhs's elements.
+    Container result(lhs);
+    result.subtract(rhs);
+    return result;
+  }
+  Container result(lhs.get_allocator());
+  auto hash = lhs.hash_function();
+  result.reserve(lhs.size());
+  for (const auto& x : lhs) {
+    auto h = hash(x);
+    if (rhs.find_with_hash(x, h) == rhs.cend()) {
+      result.insert_with_hash(x, h);
+    }
+  }
+  return result;
+}
+
+}  // namespace containerofunique
@@ -0,0 +1,498 @@
+#pragma once
+
+#include <algorithm>  // For std::equal
+#include <cstddef>    // For std::ptrdiff_t
+#include <functional>  // For std::hash
+#include <initializer_list>
+#include <iterator>   // For std::reverse_iterator
+#include <memory>     // For std::allocator, std::allocator_traits
+#include <new>        // For placement new
+#include <stdexcept>  // For std::out_of_range
+#include <type_traits>
+#include <utility>  // For std::move_if_noexcept
+
+#include "hashindex.h"
+#include "vectorofunique.h"
+
+namespace containerofunique {
+
+// Vector of unique elements that keeps up to N of them inside the object.
+// While it holds at most N elements, uniqueness is checked by comparing a
+// new element with each one in turn, and nothing is hashed or allocated.
+// Pushing element N + 1 moves the elements into a vector_of_unique, which
+// hashes them once and indexes them from then on. Shrinking again does not
+// bring them back inline; shrink_to_fit() does.
+//
+// Elements are contiguous in either case, and iterators are pointers to
+// them. Any iterator is invalidated when the elements move out of line or
+// back.
+template <class T, std::size_t N, class Hash = std::hash<T>,
+          class KeyEqual = std::equal_to<T>,
+          class Allocator = std::allocator<T>, class IndexPolicy = node_index>
+class small_vector_of_unique {
+  static_assert(N > 0, "small_vector_of_unique needs an inline capacity");
+
+ public:
+  // *Member types
+  using value_type = T;
+  using key_type = T;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+  using allocator_type = Allocator;
+  using const_reference = const value_type&;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using const_iterator = const T*;
+  using iterator = const_iterator;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+  using reverse_iterator = const_reverse_iterator;
+  // Holds the elements once there have been more than N of them.
+  using spilled_type =
+      vector_of_unique<T, Hash, KeyEqual, Allocator, IndexPolicy>;
+
+  static constexpr size_type npos = static_cast<size_type>(-1);
+  static constexpr size_type inline_capacity = N;
+
+  // Member functions
+  // Constructor
+  small_vector_of_unique() : small_vector_of_unique(Allocator()) {}
+
+  explicit small_vector_of_unique(const Allocator& alloc)
+      : small_vector_of_unique(alloc, KeyEqual()) {}
+
+  template <class input_it>
+  small_vector_of_unique(input_it first, input_it last,
+                         const Allocator& alloc = Allocator())
+      : small_vector_of_unique(alloc) {
+    for (; first != last; ++first) {
+      push_back(*first);
+    }
+  }
+
+  small_vector_of_unique(std::initializer_list<T> init,
+                         const Allocator& alloc = Allocator())
+      : small_vector_of_unique(init.begin(), init.end(), alloc) {}
+
+  small_vector_of_unique(const small_vector_of_unique& other)
+      : small_vector_of_unique(
+            other, alloc_traits::select_on_container_copy_construction(
+                       other.alloc_)) {}
+
+  small_vector_of_unique(const small_vector_of_unique& other,
+                         const Allocator& alloc)
+      : small_vector_of_unique(alloc, other.eq_) {
+    _copy_from(other);
+  }
+
+  // The moved-from container is left empty.
+  small_vector_of_unique(small_vector_of_unique&& other) noexcept(
+      std::is_nothrow_move_constructible<T>::value &&
+      std::is_nothrow_move_constructible<spilled_type>::value)
+      : small_vector_of_unique(other.alloc_, other.eq_) {
+    _take(other);
+  }
+
+  small_vector_of_unique(small_vector_of_unique&& other,
+                         const Allocator& alloc)
+      : small_vector_of_unique(alloc, other.eq_) {
+    _take(other);
+  }
+
+  small_vector_of_unique& operator=(const small_vector_of_unique& other) {
+    if (this != &other) {
+      _reset();
+      eq_ = other.eq_;
+      _copy_from(other);
+    }
+    return *this;
+  }
+
+  small_vector_of_unique& operator=(small_vector_of_unique&& other) noexcept(
+      std::is_nothrow_move_constructible<T>::value &&
+      std::is_nothrow_move_constructible<spilled_type>::value) {
+    if (this != &other) {
+      _reset();
+      eq_ = std::move(other.eq_);
+      _take(other);
+    }
+    return *this;
+  }
+
+  small_vector_of_unique& operator=(std::initializer_list<T> ilist) {
+    assign(ilist.begin(), ilist.end());
+    return *this;
+  }
+
+  ~small_vector_of_unique() { _reset(); }
+
+  template <class input_it>
+  void assign(input_it first, input_it last) {
+    clear();
+    for (; first != last; ++first) {
+      push_back(*first);
+    }
+  }
+
+  // Element access
+  const_reference at(size_type pos) const {
+    if (pos >= size()) {
+      throw std::out_of_range("small_vector_of_unique::at");
+    }
+    return data()[pos];
+  }
+  const_reference operator[](size_type pos) const { return data()[pos]; }
+  const_reference front() const { return data()[0]; }
+  const_reference back() const { return data()[size() - 1]; }
+  const T* data() const noexcept {
+    return spilled_ ? heap_.vector().data() : _inline();
+  }
+
+  // Iterators
+  const_iterator cbegin() const noexcept { return data(); }
+  const_iterator cend() const noexcept { return data() + size(); }
+
+  iterator begin() const noexcept { return cbegin(); }
+  iterator end() const noexcept { return cend(); }
+
+  const_reverse_iterator crbegin() const noexcept {
+    return const_reverse_iterator(cend());
+  }
+  const_reverse_iterator crend() const noexcept {
+    return const_reverse_iterator(cbegin());
+  }
+
+  reverse_iterator rbegin() const noexcept { return crbegin(); }
+  reverse_iterator rend() const noexcept { return crend(); }
+
+  // Modifiers
+  // Keeps the storage the elements are in, like std::vector::clear.
+  void clear() noexcept {
+    if (spilled_) {
+      heap_.clear();
+    } else {
+      _destroy_inline(0);
+    }
+  }
+
+  // Precondition: pos must be a valid and dereferenceable iterator of this
+  // container.
+  const_iterator erase(const_iterator pos) {
+    auto i = static_cast<size_type>(pos - cbegin());
+    if (spilled_) {
+      heap_.erase(heap_.cbegin() + static_cast<difference_type>(i));
+    } else {
+      auto p = _inline();
+      std::move(p + i + 1, p + size_, p + i);
+      _destroy_inline(size_ - 1);
+    }
+    return cbegin() + i;
+  }
+
+  void pop_back() {
+    if (spilled_) {
+      heap_.pop_back();
+    } else if (size_ != 0) {
+      _destroy_inline(size_ - 1);
+    }
+  }
+
+  // Appends value if it is not present. Returns true if value was added.
+  bool push_back(const T& value) { return _push_back(value); }
+
+  bool push_back(T&& value) { return _push_back(std::move(value)); }
+
+  // Constructs an element from args and appends it if it is not present.
+  // Returns true if it was added.
+  template <class... Args>
+  bool emplace_back(Args&&... args) {
+    if (spilled_) {
+      auto old_size = heap_.size();
+      heap_.emplace_back(std::forward<Args>(args)...);
+      return heap_.size() != old_size;
+    }
+    if (size_ == N) {
+      return _push_back(T(std::forward<Args>(args)...));
+    }
+    auto p = _inline() + size_;
+    alloc_traits::construct(alloc_, p, std::forward<Args>(args)...);
+    if (_scan(*p) != npos) {
+      alloc_traits::destroy(alloc_, p);
+      return false;
+    }
+    ++size_;
+    return true;
+  }
+
+  // Removes every element for which pred returns true, keeping the order of
+  // the others. Returns the number of elements removed.
+  template <class Pred>
+  size_type remove_if(Pred pred) {
+    if (spilled_) {
+      return heap_.remove_if(pred);
+    }
+    auto p = _inline();
+    size_type kept = 0;
+    for (size_type i = 0; i < size_; ++i) {
+      if (!pred(static_cast<const T&>(p[i]))) {
+        if (kept != i) {
+          p[kept] = std::move(p[i]);
+        }
+        ++kept;
+      }
+    }
+    auto removed = size_ - kept;
+    _destroy_inline(kept);
+    return removed;
+  }
+
+  void swap(small_vector_of_unique& other) noexcept(
+      std::is_nothrow_move_constructible<T>::value &&
+      std::is_nothrow_move_constructible<spilled_type>::value) {
+    small_vector_of_unique tmp(std::move(other));
+    other = std::move(*this);
+    *this = std::move(tmp);
+  }
+
+  // Capacity
+  bool empty() const noexcept { return size() == 0; }
+  size_type size() const noexcept { return spilled_ ? heap_.size() : size_; }
+  size_type capacity() const noexcept {
+    return spilled_ ? heap_.capacity() : N;
+  }
+  // Whether the elements are stored inside the object.
+  bool is_inline() const noexcept { return !spilled_; }
+
+  // Moves the elements out of line, hashing them, if new_cap exceeds N.
+  void reserve(size_type new_cap) {
+    if (spilled_) {
+      heap_.reserve(new_cap);
+    } else if (new_cap > N) {
+      _spill(new_cap);
+    }
+  }
+
+  // Brings the elements back inline if there are at most N of them, which
+  // frees the vector and the index.
+  void shrink_to_fit() {
+    if (!spilled_) {
+      return;
+    }
+    if (heap_.size() > N) {
+      heap_.shrink_to_fit();
+      return;
+    }
+    auto seq = std::move(heap_).release();
+    heap_.~spilled_type();
+    spilled_ = false;
+    for (auto& v : seq) {
+      alloc_traits::construct(alloc_, _inline() + size_,
+                              std::move_if_noexcept(v));
+      ++size_;
+    }
+  }
+
+  // Look up
+  const_iterator find(const key_type& key) const {
+    if (spilled_) {
+      auto it = heap_.find(key);
+      return cbegin() + (it - heap_.cbegin());
+    }
+    auto i = _scan(key);
+    return i == npos ? cend() : cbegin() + i;
+  }
+
+  // Returns the position of key, or npos if it is not present.
+  size_type index_of(const key_type& key) const {
+    return spilled_ ? heap_.index_of(key) : _scan(key);
+  }
+
+#if __cplusplus >= 202002L
+  bool contains(const key_type& key) const { return index_of(key) != npos; }
+#endif
+
+  // Observers
+  allocator_type get_allocator() const noexcept { return alloc_; }
+  hasher hash_function() const {
+    return spilled_ ? heap_.hash_function() : Hash();
+  }
+  key_equal key_eq() const { return eq_; }
+
+ private:
+  using alloc_traits = std::allocator_traits<Allocator>;
+
+  small_vector_of_unique(const Allocator& alloc, const KeyEqual& eq)
+      : alloc_(alloc), eq_(eq) {}
+
+  T* _inline() noexcept { return reinterpret_cast<T*>(storage_); }
+  const T* _inline() const noexcept {
+    return reinterpret_cast<const T*>(storage_);
+  }
+
+  // Position of the inline element equal to key, or npos.
+  template <class K>
+  size_type _scan(const K& key) const {
+    auto p = _inline();
+    for (size_type i = 0; i < size_; ++i) {
+      if (eq_(p[i], key)) {
+        return i;
+      }
+    }
+    return npos;
+  }
+
+  template <class V>
+  bool _push_back(V&& value) {
+    if (spilled_) {
+      return heap_.push_back(std::forward<V>(value));
+    }
+    if (_scan(value) != npos) {
+      return false;
+    }
+    if (size_ == N) {
+      _spill(2 * N);
+      return heap_.push_back(std::forward<V>(value));
+    }
+    alloc_traits::construct(alloc_, _inline() + size_, std::forward<V>(value));
+    ++size_;
+    return true;
+  }
+
+  // Moves the inline elements into a vector_of_unique sized for new_cap
+  // elements. They are known to be unique, so each is only hashed.
+  void _spill(size_type new_cap) {
+    typename spilled_type::VectorType seq(alloc_);
+    seq.reserve(new_cap);
+    auto p = _inline();
+    for (size_type i = 0; i < size_; ++i) {
+      seq.push_back(std::move_if_noexcept(p[i]));
+    }
+    auto heap = spilled_type::adopt_unique(std::move(seq));
+    heap.reserve(new_cap);
+    _destroy_inline(0);
+    ::new (static_cast<void*>(&heap_)) spilled_type(std::move(heap));
+    spilled_ = true;
+  }
+
+  // Destroys the inline elements from position from on.
+  void _destroy_inline(size_type from) noexcept {
+    auto p = _inline();
+    for (auto i = from; i < size_; ++i) {
+      alloc_traits::destroy(alloc_, p + i);
+    }
+    size_ = from;
+  }
+
+  // Destroys the elements and goes back to inline storage.
+  void _reset() noexcept {
+    if (spilled_) {
+      heap_.~spilled_type();
+      spilled_ = false;
+    } else {
+      _destroy_inline(0);
+    }
+  }
+
+  // Precondition: this container is empty and inline.
+  void _copy_from(const small_vector_of_unique& other) {
+    if (other.spilled_) {
+      ::new (static_cast<void*>(&heap_)) spilled_type(other.heap_, alloc_);
+      spilled_ = true;
+      return;
+    }
+    for (const auto& v : other) {
+      alloc_traits::construct(alloc_, _inline() + size_, v);
+      ++size_;
+    }
+  }
+
+  // Moves the elements of other here and leaves other empty.
+  // Precondition: this container is empty and inline.
+  void _take(small_vector_of_unique& other) {
+    if (other.spilled_) {
+      ::new (static_cast<void*>(&heap_))
+          spilled_type(std::move(other.heap_), alloc_);
+      spilled_ = true;
+      return;
+    }
+    auto p = other._inline();
+    for (size_type i = 0; i < other.size_; ++i) {
+      alloc_traits::construct(alloc_, _inline() + size_, std::move(p[i]));
+      ++size_;
+    }
+    other._destroy_inline(0);
+  }
+
+  Allocator alloc_;
+  KeyEqual eq_;
+  // Number of inline elements, while not spilled_.
+  size_type size_ = 0;
+  bool spilled_ = false;
+  union {
+    alignas(T) unsigned char storage_[sizeof(T) * N];
+    spilled_type heap_;
+  };
+};  // class small_vector_of_unique
+
+#if __cplusplus < 201703L
+template <class T, std::size_t N, class Hash, class KeyEqual, class Allocator,
+          class IndexPolicy>
+constexpr typename small_vector_of_unique<T, N, Hash, KeyEqual, Allocator,
+                                          IndexPolicy>::size_type
+    small_vector_of_unique<T, N, Hash, KeyEqual, Allocator, IndexPolicy>::npos;
+
+template <class T, std::size_t N, class Hash, class KeyEqual, class Allocator,
+          class IndexPolicy>
+constexpr typename small_vector_of_unique<T, N, Hash, KeyEqual, Allocator,
+                                          IndexPolicy>::size_type
+    small_vector_of_unique<T, N, Hash, KeyEqual, Allocator,
+                           IndexPolicy>::inline_capacity;
+#endif
+
+// Non-member functions
+template <class T, std::size_t N, class Hash, class KeyEqual, class Allocator,
+          class IndexPolicy, class U = T>
+typename small_vector_of_unique<T, N, Hash, KeyEqual, Allocator,
+                                IndexPolicy>::size_type
+erase(small_vector_of_unique<T, N, Hash, KeyEqual, Allocator, IndexPolicy>& c,
+      const U& value) {
+  auto it = c.find(value);
+  if (it != c.cend()) {
+    c.erase(it);
+    return 1;
+  }
+  return 0;
+}
+
+template <class T, std::size_t N, class Hash, class KeyEqual, class Allocator,
+          class IndexPolicy, class Pred>
+typename small_vector_of_unique<T, N, Hash, KeyEqual, Allocator,
+                                IndexPolicy>::size_type
+erase_if(
+    small_vector_of_unique<T, N, Hash, KeyEqual, Allocator, IndexPolicy>& c,
+    Pred pred) {
+  return c.remove_if(pred);
+}
+
+// Operators
+template <class T, std::size_t N, class Hash, class KeyEqual, class Allocator,
+          class IndexPolicy>
+bool operator==(
+    const small_vector_of_unique<T, N, Hash, KeyEqual, Allocator, IndexPolicy>&
+        lhs,
+    const small_vector_of_unique<T, N, Hash, KeyEqual, Allocator, IndexPolicy>&
+        rhs) {
+  return lhs.size() == rhs.size() &&
+         std::equal(lhs.cbegin(), lhs.cend(), rhs.cbegin());
+}
+
+template <class T, std::size_t N, class Hash, class KeyEqual, class Allocator,
+          class IndexPolicy>
+bool operator!=(
+    const small_vector_of_unique<T, N, Hash, KeyEqual, Allocator, IndexPolicy>&
+        lhs,
+    const small_vector_of_unique<T, N, Hash, KeyEqual, Allocator, IndexPolicy>&
+        rhs) {
+  return !(lhs == rhs);
+}
+
+}  // namespace containerofunique
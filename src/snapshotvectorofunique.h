@@ -0,0 +1,300 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>     // For std::size_t
+#include <cstdint>     // For std::uint64_t
+#include <functional>  // For std::hash
+#include <memory>  // For std::allocator, std::allocator_traits, std::shared_ptr
+#include <mutex>
+#include <thread>  // For std::this_thread, std::thread::hardware_concurrency
+#include <utility>  // For std::move, std::pair, std::swap
+#include <vector>
+
+#include "vectorofunique.h"
+
+namespace containerofunique {
+
+// vector_of_unique for read-mostly data shared between threads, RCU style.
+//
+// Every published version is immutable. Writers are serialized by a mutex;
+// each write copies the current version, applies the change and publishes
+// the copy with one atomic store, so a batch of changes should go through a
+// single update(). Readers never block writers or each other:
+//
+// - read() pins the current version and returns a guard through which it
+//   is searched and iterated with plain, wait-free vector_of_unique calls.
+//   Pinning claims one of reader_slots() slots, and is wait-free as long as
+//   no more than reader_slots() guards are alive at once.
+// - snapshot() returns the current version as a reference-counted
+//   std::shared_ptr, for readers that keep it for a long time.
+//
+// Replaced versions are reclaimed by epochs: a write retires the old
+// version tagged with the epoch in which it was unpublished, and frees it
+// once every pinned reader has pinned in a later epoch. A guard held for a
+// long time delays reclamation but never blocks a writer.
+template <class T, class Hash = std::hash<T>, class KeyEqual = std::equal_to<T>,
+          class Allocator = std::allocator<T>, class IndexPolicy = node_index>
+class snapshot_vector_of_unique {
+  struct version;
+
+ public:
+  // *Member types
+  using value_type = T;
+  using key_type = T;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+  using allocator_type = Allocator;
+  using vector_type =
+      vector_of_unique<T, Hash, KeyEqual, Allocator, IndexPolicy>;
+  using snapshot_type = std::shared_ptr<const vector_type>;
+  using size_type = typename vector_type::size_type;
+
+  // Pins one version for as long as it is alive. Move-only.
+  class read_guard {
+   public:
+    read_guard(read_guard&& other) noexcept
+        : owner_(other.owner_), slot_(other.slot_), version_(other.version_) {
+      other.owner_ = nullptr;
+    }
+    read_guard& operator=(read_guard&& other) noexcept {
+      std::swap(owner_, other.owner_);
+      std::swap(slot_, other.slot_);
+      std::swap(version_, other.version_);
+      return *this;
+    }
+    read_guard(const read_guard&) = delete;
+    read_guard& operator=(const read_guard&) = delete;
+
+    ~read_guard() {
+      if (owner_ != nullptr) {
+        owner_->_unpin(slot_);
+      }
+    }
+
+    const vector_type& operator*() const noexcept { return *version_->data; }
+    const vector_type* operator->() const noexcept {
+      return version_->data.get();
+    }
+
+   private:
+    friend class snapshot_vector_of_unique;
+
+    read_guard(const snapshot_vector_of_unique* owner, size_type slot,
+               const version* v) noexcept
+        : owner_(owner), slot_(slot), version_(v) {}
+
+    const snapshot_vector_of_unique* owner_;
+    size_type slot_;
+    const version* version_;
+  };
+
+  // Member functions
+  // Constructor
+  explicit snapshot_vector_of_unique(
+      size_type reader_slots = default_reader_slots(),
+      const Allocator& alloc = Allocator())
+      : snapshot_vector_of_unique(vector_type(alloc), reader_slots) {}
+
+  explicit snapshot_vector_of_unique(
+      vector_type initial, size_type reader_slots = default_reader_slots())
+      : alloc_(initial.get_allocator()),
+        slot_count_(reader_slots == 0 ? 1 : reader_slots),
+        slots_(new reader_slot[slot_count_]) {
+    current_.store(_make_version(std::move(initial)));
+  }
+
+  snapshot_vector_of_unique(const snapshot_vector_of_unique&) = delete;
+  snapshot_vector_of_unique& operator=(const snapshot_vector_of_unique&) =
+      delete;
+
+  // No read_guard may outlive the container.
+  ~snapshot_vector_of_unique() {
+    _free_version(current_.load());
+    for (const auto& r : retired_) {
+      _free_version(r.first);
+    }
+  }
+
+  // Readers
+  read_guard read() const {
+    auto slot = _pin();
+    return read_guard(this, slot, current_.load());
+  }
+
+  snapshot_type snapshot() const { return read().version_->data; }
+
+  size_type size() const { return read()->size(); }
+  bool empty() const { return read()->empty(); }
+
+  size_type index_of(const key_type& key) const {
+    return read()->index_of(key);
+  }
+
+#if __cplusplus >= 202002L
+  bool contains(const key_type& key) const { return read()->contains(key); }
+#endif
+
+  // Writers. Each call publishes at most one new version.
+
+  // Calls f(vector_type&) on a copy of the current version and publishes
+  // the copy.
+  template <class F>
+  void update(F f) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    vector_type next(*current_.load()->data, alloc_);
+    f(next);
+    _publish(std::move(next));
+  }
+
+  // Publishes v as the new version.
+  void publish(vector_type v) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    _publish(std::move(v));
+  }
+
+  // Appends value if it is not present; a duplicate publishes nothing.
+  bool push_back(const T& value) { return _push_back(value); }
+  bool push_back(T&& value) { return _push_back(std::move(value)); }
+
+  // Removes key if it is present; returns the number of elements removed.
+  size_type erase(const key_type& key) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    const auto& current = *current_.load()->data;
+    auto pos = current.index_of(key);
+    if (pos == vector_type::npos) {
+      return 0;
+    }
+    vector_type next(current, alloc_);
+    next.erase(next.cbegin() + static_cast<std::ptrdiff_t>(pos));
+    _publish(std::move(next));
+    return 1;
+  }
+
+  void clear() { publish(vector_type(alloc_)); }
+
+  // Observers
+  allocator_type get_allocator() const noexcept { return alloc_; }
+  size_type reader_slots() const noexcept { return slot_count_; }
+
+  // Versions replaced but not yet freed because a reader may still use
+  // them.
+  size_type retired() const {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    return retired_.size();
+  }
+
+  static size_type default_reader_slots() noexcept {
+    auto threads = std::thread::hardware_concurrency();
+    return threads == 0 ? 64 : 4 * static_cast<size_type>(threads);
+  }
+
+ private:
+  struct version {
+    snapshot_type data;
+  };
+
+  // Pinned epoch of one reader, or 0 when the slot is free. Slots are padded
+  // apart so readers on different slots do not share a cache line.
+  struct reader_slot {
+    std::atomic<std::uint64_t> epoch{0};
+    char padding[64 - sizeof(std::atomic<std::uint64_t>)];
+  };
+
+  using version_allocator =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<version>;
+  using version_traits = std::allocator_traits<version_allocator>;
+
+  version* _make_version(vector_type v) {
+    version_allocator va(alloc_);
+    auto* p = version_traits::allocate(va, 1);
+    try {
+      auto data = std::allocate_shared<vector_type>(alloc_, std::move(v));
+      version_traits::construct(va, p, version{std::move(data)});
+    } catch (...) {
+      version_traits::deallocate(va, p, 1);
+      throw;
+    }
+    return p;
+  }
+
+  void _free_version(version* p) noexcept {
+    version_allocator va(alloc_);
+    version_traits::destroy(va, p);
+    version_traits::deallocate(va, p, 1);
+  }
+
+  // Claims a free slot, starting from one picked by thread id so threads
+  // rarely collide, and records the current epoch in it. A version loaded
+  // after this is not freed before the slot is released: it can only be
+  // retired in this epoch or later.
+  size_type _pin() const {
+    auto slot = std::hash<std::thread::id>()(std::this_thread::get_id()) %
+                slot_count_;
+    for (;;) {
+      auto e = epoch_.load();
+      std::uint64_t free_slot = 0;
+      if (slots_[slot].epoch.compare_exchange_strong(free_slot, e)) {
+        return slot;
+      }
+      slot = slot + 1 == slot_count_ ? 0 : slot + 1;
+    }
+  }
+
+  // Release is enough: the writer that sees the slot free also sees every
+  // read made through it.
+  void _unpin(size_type slot) const noexcept {
+    slots_[slot].epoch.store(0, std::memory_order_release);
+  }
+
+  template <class V>
+  bool _push_back(V&& value) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    const auto& current = *current_.load()->data;
+    if (current.index_of(value) != vector_type::npos) {
+      return false;
+    }
+    vector_type next(current, alloc_);
+    next.push_back(std::forward<V>(value));
+    _publish(std::move(next));
+    return true;
+  }
+
+  // Caller holds write_mutex_.
+  void _publish(vector_type next) {
+    retired_.reserve(retired_.size() + 1);
+    auto* old = current_.exchange(_make_version(std::move(next)));
+    retired_.emplace_back(old, epoch_.fetch_add(1));
+    _reclaim();
+  }
+
+  // Frees every retired version that no pinned reader can still see.
+  void _reclaim() noexcept {
+    auto oldest_pin = static_cast<std::uint64_t>(-1);
+    for (size_type i = 0; i < slot_count_; ++i) {
+      auto e = slots_[i].epoch.load();
+      if (e != 0 && e < oldest_pin) {
+        oldest_pin = e;
+      }
+    }
+    size_type kept = 0;
+    for (auto& r : retired_) {
+      if (r.second < oldest_pin) {
+        _free_version(r.first);
+      } else {
+        retired_[kept++] = r;
+      }
+    }
+    retired_.resize(kept);
+  }
+
+  Allocator alloc_;
+  size_type slot_count_;
+  std::unique_ptr<reader_slot[]> slots_;
+  std::atomic<version*> current_{nullptr};
+  // Epoch 0 marks a free slot, so epochs start at 1.
+  std::atomic<std::uint64_t> epoch_{1};
+  mutable std::mutex write_mutex_;
+  std::vector<std::pair<version*, std::uint64_t>> retired_;
+};
+
+}  // namespace containerofunique
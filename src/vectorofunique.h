@@ -1,11 +1,22 @@
 #pragma once
 
+#include <algorithm>  // For std::max, std::rotate
+#include <array>
+#include <cassert>
+#include <cstdint>  // For std::uint64_t
 #include <functional>  // For std::hash
 #include <initializer_list>
+#include <iterator>  // For std::distance, std::iterator_traits
+#include <memory>  // For std::allocator, std::allocator_traits
 #include <optional>  // For std::nullopt
-#include <unordered_set>
+#include <type_traits>
 #include <utility>  // For std::swap
 #include <vector>
+
+#include "hashindex.h"
+#if __cplusplus >= 201703L && __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
 #if __cplusplus >= 202302L
 #include <ranges>
 #endif
@@ -20,7 +31,8 @@
 
 namespace containerofunique {
 
-template <class T, class Hash = std::hash<T>, class KeyEqual = std::equal_to<T>>
+template <class T, class Hash = std::hash<T>, class KeyEqual = std::equal_to<T>,
+          class Allocator = std::allocator<T>, class IndexPolicy = node_index>
 class vector_of_unique {
  public:
   // *Member types
@@ -28,52 +40,104 @@ class vector_of_unique {
   using key_type = T;
   using hasher = Hash;
   using key_equal = KeyEqual;
+  using allocator_type = Allocator;
   using const_reference = const value_type&;
-  using VectorType = std::vector<T>;
-  using UnorderedSetType = std::unordered_set<T, Hash, KeyEqual>;
+  using VectorType = std::vector<T, Allocator>;
+  using IndexType =
+      typename IndexPolicy::template type<typename VectorType::size_type,
+                                          Allocator>;
+  using SetViewType = detail::set_view<vector_of_unique>;
   using size_type = typename VectorType::size_type;
   using const_iterator = typename VectorType::const_iterator;
   using iterator = const_iterator;
   using reverse_iterator = typename VectorType::reverse_iterator;
   using const_reverse_iterator = typename VectorType::const_reverse_iterator;
+  using node_type =
+      detail::unique_node_handle<T, Hash, typename IndexType::entry_type>;
+  using insert_return_type =
+      detail::node_insert_return<const_iterator, node_type>;
+
+  static constexpr size_type npos = static_cast<size_type>(-1);
 
   // Member functions
   // Constructor
   vector_of_unique() NOEXCEPT_CXX17 = default;
 
+  explicit vector_of_unique(const Allocator& alloc)
+      : vector_(alloc), index_(alloc) {}
+
   template <class input_it>
-  vector_of_unique(input_it first, input_it last) {
-    _push_back(first, last);
+  vector_of_unique(input_it first, input_it last,
+                   const Allocator& alloc = Allocator())
+      : vector_(alloc), index_(alloc) {
+    append_bulk(first, last);
   }
 
-  vector_of_unique(const std::initializer_list<T>& init)
-      : vector_of_unique(init.begin(), init.end()) {}
+  vector_of_unique(const std::initializer_list<T>& init,
+                   const Allocator& alloc = Allocator())
+      : vector_of_unique(init.begin(), init.end(), alloc) {}
+
+  vector_of_unique(const vector_of_unique& other)
+      : vector_of_unique(
+            other, AllocTraits::select_on_container_copy_construction(
+                       other.get_allocator())) {}
+
+  // The source is already unique, so copies clone the index as is instead of
+  // rehashing and re-checking every element.
+  vector_of_unique(const vector_of_unique& other, const Allocator& alloc)
+      : vector_(other.vector_, alloc),
+        index_(other.index_, alloc),
+        hash_(other.hash_),
+        eq_(other.eq_) {}
 
-  vector_of_unique(const vector_of_unique& other) { _push_back(other); }
+  vector_of_unique(vector_of_unique&& other) NOEXCEPT_CXX17
+      : vector_(std::move(other.vector_)),
+        index_(std::move(other.index_)),
+        hash_(std::move(other.hash_)),
+        eq_(std::move(other.eq_)) {
+    other.clear();
+  }
+
+  vector_of_unique(vector_of_unique&& other, const Allocator& alloc)
+      : vector_(std::move(other.vector_), alloc),
+        index_(std::move(other.index_), alloc),
+        hash_(std::move(other.hash_)),
+        eq_(std::move(other.eq_)) {
+    other.clear();
+  }
 
-  vector_of_unique(vector_of_unique&& other) NOEXCEPT_CXX17 {
-    std::swap(vector_, other.vector_);
-    std::swap(set_, other.set_);
+  // Takes ownership of seq, whose elements must already be unique, and only
+  // builds the index over them; no element is compared with another except
+  // by an assertion in debug builds.
+  static vector_of_unique adopt_unique(VectorType&& seq) {
+    vector_of_unique result(seq.get_allocator());
+    result.vector_ = std::move(seq);
+    result.index_.reserve(result.vector_.size());
+    for (size_type i = 0; i < result.vector_.size(); ++i) {
+      auto h = result.hash_(result.vector_[i]);
+      assert(result._find(h, result.vector_[i]) == nullptr &&
+             "adopt_unique: duplicate element");
+      result.index_.insert(h, i);
+    }
+    return result;
   }
 
   vector_of_unique& operator=(const vector_of_unique& other) = default;
   vector_of_unique& operator=(vector_of_unique&& other) = default;
   vector_of_unique& operator=(std::initializer_list<T> ilist) {
-    vector_of_unique temp(ilist);
-    std::swap(vector_, temp.vector_);
-    std::swap(set_, temp.set_);
+    assign(ilist);
     return *this;
   }
 
   template <class input_it>
   void assign(input_it first, input_it last) {
     clear();
-    _push_back(first, last);
+    append_bulk(first, last);
   }
 
   void assign(std::initializer_list<T> ilist) {
     clear();
-    _push_back(ilist.begin(), ilist.end());
+    append_bulk(ilist.begin(), ilist.end());
   }
 
 #if __cplusplus >= 202302L
@@ -104,14 +168,16 @@ class vector_of_unique {
   // Modifiers
   void clear() noexcept {
     vector_.clear();
-    set_.clear();
+    index_.clear();
   }
 
   // Precondition: pos must be a valid and dereferenceable iterator of this
   // container (i.e. pos != cend()). Violating this is undefined behaviour,
   // matching the contract of std::vector::erase.
   const_iterator erase(const_iterator pos) {
-    set_.erase(*pos);
+    auto pos_index = static_cast<size_type>(pos - vector_.cbegin());
+    index_.erase(_hash_at(pos_index), pos_index);
+    _close_gap(pos_index + 1, 1);
     return vector_.erase(pos);
   }
 
@@ -120,46 +186,114 @@ class vector_of_unique {
       return last;
     }
 
-    for (auto it = first; it != last; ++it) {
-      set_.erase(*it);
+    auto first_index = static_cast<size_type>(first - vector_.cbegin());
+    auto last_index = static_cast<size_type>(last - vector_.cbegin());
+    if (last == vector_.cend()) {
+      for (auto i = last_index; i != first_index;) {
+        --i;
+        index_.erase(_hash_at(i), i);
+      }
+    } else {
+      // One pass over the index both drops the erased range and closes the
+      // gap, without rehashing any element.
+      auto count = last_index - first_index;
+      index_.remap([first_index, last_index, count](size_type& p) {
+        if (p < first_index) {
+          return true;
+        }
+        if (p < last_index) {
+          return false;
+        }
+        p -= count;
+        return true;
+      });
     }
 
     return vector_.erase(first, last);
   }
 
+  // Removes the element at pos and returns it in a node handle, with its
+  // hash and index entry. Precondition: pos != cend().
+  node_type extract(const_iterator pos) {
+    auto pos_index = static_cast<size_type>(pos - vector_.cbegin());
+    auto hash = _hash_at(pos_index);
+    node_type nh(std::move(vector_[pos_index]), hash);
+    nh.entry_ = index_.extract(hash, pos_index);
+    _close_gap(pos_index + 1, 1);
+    vector_.erase(pos);
+    return nh;
+  }
+
+  // Extracts key if it is present, and returns an empty handle otherwise.
+  node_type extract(const key_type& key) {
+    auto p = _find(key);
+    return p == nullptr ? node_type() : extract(cbegin() + *p);
+  }
+
+  // Removes the element at pos in O(1) by moving the last element into its
+  // place, so the order of the remaining elements is not preserved. Returns
+  // an iterator to the element that now occupies pos, or cend() if pos was
+  // the last element.
+  const_iterator unordered_erase(const_iterator pos) {
+    auto pos_index = static_cast<size_type>(pos - vector_.cbegin());
+    _unordered_erase(pos_index, _hash_at(pos_index));
+    return vector_.cbegin() + pos_index;
+  }
+
+  // Removes key, if present, in O(1) like unordered_erase(pos). Returns the
+  // number of elements removed (0 or 1).
+  size_type unordered_erase(const key_type& key) {
+    auto h = hash_(key);
+    auto p = _find(h, key);
+    if (p == nullptr) {
+      return 0;
+    }
+    _unordered_erase(*p, h);
+    return 1;
+  }
+
+#if __cplusplus >= 202002L
+  template <class K>
+    requires requires {
+      typename Hash::is_transparent;
+      typename KeyEqual::is_transparent;
+    }
+  size_type unordered_erase(const K& x) {
+    auto h = hash_(x);
+    auto p = _find(h, x);
+    if (p == nullptr) {
+      return 0;
+    }
+    _unordered_erase(*p, h);
+    return 1;
+  }
+#endif
+
   std::pair<const_iterator, bool> insert(const_iterator pos, const T& value) {
-    if (set_.insert(value).second) {
-      return std::make_pair(vector_.insert(pos, value), true);
+    auto h = hash_(value);
+    if (_find(h, value) == nullptr) {
+      return std::make_pair(_insert(pos, h, value), true);
     }
     return std::make_pair(pos, false);
   }
 
   std::pair<const_iterator, bool> insert(const_iterator pos, T&& value) {
-    if (set_.insert(value).second) {
-      return std::make_pair(vector_.insert(pos, std::move(value)), true);
+    auto h = hash_(value);
+    if (_find(h, value) == nullptr) {
+      return std::make_pair(_insert(pos, h, std::move(value)), true);
     }
     return std::make_pair(pos, false);
   }
 
+  // Inserts the elements of [first, last) that are not already present
+  // before pos, keeping their order, and returns an iterator to the first
+  // one inserted, or pos if there was none. Like insert_bulk, the tail
+  // moves once however many elements are inserted.
   template <class input_it>
   const_iterator insert(const_iterator pos, input_it first, input_it last) {
     auto pos_index = pos - vector_.cbegin();
-    auto first_inserted_index = pos_index;
-    auto temp_pos = vector_.begin() + (pos - vector_.cbegin());
-    auto any_inserted = false;
-
-    for (auto it = first; it != last; ++it) {
-      if (set_.insert(*it).second) {
-        temp_pos = vector_.insert(temp_pos, *it);
-        if (!any_inserted) {
-          first_inserted_index = temp_pos - vector_.cbegin();
-          any_inserted = true;
-        }
-        ++temp_pos;
-      }
-    }
-    return any_inserted ? first_inserted_index + vector_.cbegin()
-                        : pos_index + vector_.cbegin();
+    insert_bulk(pos, first, last);
+    return vector_.cbegin() + pos_index;
   }
 
   const_iterator insert(const_iterator pos, std::initializer_list<T> ilist) {
@@ -169,73 +303,150 @@ class vector_of_unique {
 #if __cplusplus >= 202302L
   template <std::ranges::input_range R>
   const_iterator insert_range(const_iterator pos, R&& rng) {
-    auto pos_index = pos - vector_.cbegin();
-    auto first_inserted_index = pos_index;
-    auto temp_pos = vector_.begin() + pos_index;
-    auto any_inserted = false;
+    auto pos_index = static_cast<size_type>(pos - vector_.cbegin());
+    auto old_size = vector_.size();
+    if constexpr (std::ranges::sized_range<R>) {
+      _reserve_more(static_cast<size_type>(std::ranges::size(rng)));
+    }
     for (auto&& v : std::forward<R>(rng)) {
-      if (set_.insert(v).second) {
-        temp_pos = vector_.insert(temp_pos, std::forward<decltype(v)>(v));
-        if (!any_inserted) {
-          first_inserted_index = temp_pos - vector_.cbegin();
-          any_inserted = true;
-        }
-        ++temp_pos;
-      }
+      _push_back(hash_(v), std::forward<decltype(v)>(v));
     }
-    return any_inserted ? first_inserted_index + vector_.cbegin()
-                        : pos_index + vector_.cbegin();
+    _rotate_appended(pos_index, old_size);
+    return vector_.cbegin() + pos_index;
   }
 #endif
 
+  // At the end this is emplace_back. Elsewhere one temporary is constructed
+  // and hashed, and moved into place only if it is not a duplicate.
   template <class... Args>
   std::pair<const_iterator, bool> emplace(const_iterator pos, Args&&... args) {
-    if (set_.emplace(args...).second) {
-      return std::make_pair(vector_.emplace(pos, std::forward<Args>(args)...),
-                            true);
+    if (pos == vector_.cend()) {
+      auto inserted = _emplace_back(std::forward<Args>(args)...);
+      return std::make_pair(inserted ? vector_.cend() - 1 : vector_.cend(),
+                            inserted);
     }
-    return std::make_pair(pos, false);
+    return insert(pos, T(std::forward<Args>(args)...));
   }
 
+// With spare capacity the element is constructed in place at the end and
+// removed again if it turns out to be a duplicate, so it is never copied or
+// moved. When the vector is full, one temporary is constructed and moved in
+// only if it is not a duplicate, so a rejected duplicate never reallocates.
 #if __cplusplus < 201703L
   template <class... Args>
   void emplace_back(Args&&... args) {
-    if (set_.emplace(args...).second) {
-      vector_.emplace_back(std::forward<Args>(args)...);
-    }
+    _emplace_back(std::forward<Args>(args)...);
   }
 #else
   template <class... Args>
   std::optional<std::reference_wrapper<T>> emplace_back(Args&&... args) {
-    if (set_.emplace(args...).second) {
-      return vector_.emplace_back(std::forward<Args>(args)...);
+    if (_emplace_back(std::forward<Args>(args)...)) {
+      return vector_.back();
     }
     return std::nullopt;
   }
 #endif
 
+  // Removes every element for which pred returns true, in a single
+  // compacting pass that keeps the relative order of the survivors. pred is
+  // called exactly once per element. Returns the number of elements removed.
+  template <class Pred>
+  size_type remove_if(Pred pred) {
+    return _remove_positions([&](size_type pos) {
+      const auto& v = vector_[pos];
+      return pred(v);
+    });
+  }
+
+  // Set operations. other may be any vector_of_unique or deque_of_unique of
+  // T whose Hash and KeyEqual agree with this container's, and the result
+  // keeps this container's order. intersect_with and subtract hash only the
+  // elements of the smaller side and probe the larger side's index with
+  // them.
+
+  // Appends the elements of other that are not already present, in other's
+  // order, sizing once up front. Returns the number appended.
+  template <class Container>
+  size_type merge_from(const Container& other) {
+    if (static_cast<const void*>(&other) == this) {
+      return 0;
+    }
+    return append_bulk(other.cbegin(), other.cend());
+  }
+
+  // Removes the elements that other does not contain. Returns the number
+  // removed.
+  template <class Container>
+  size_type intersect_with(const Container& other) {
+    if (static_cast<const void*>(&other) == this) {
+      return 0;
+    }
+    if (other.size() < size()) {
+      auto found = _positions_of(other);
+      return _remove_positions([&](size_type pos) { return !found[pos]; });
+    }
+    return _remove_positions([&](size_type pos) {
+      return other.find_with_hash(vector_[pos], _hash_at(pos)) == other.cend();
+    });
+  }
+
+  // Removes the elements that other contains. Returns the number removed.
+  template <class Container>
+  size_type subtract(const Container& other) {
+    if (static_cast<const void*>(&other) == this) {
+      auto removed = size();
+      clear();
+      return removed;
+    }
+    if (other.size() < size()) {
+      auto found = _positions_of(other);
+      return _remove_positions([&](size_type pos) { return found[pos]; });
+    }
+    return _remove_positions([&](size_type pos) {
+      return other.find_with_hash(vector_[pos], _hash_at(pos)) != other.cend();
+    });
+  }
+
   void pop_back() {
     if (!vector_.empty()) {
-      const auto& f = vector_.back();
-      set_.erase(f);
+      auto last_index = vector_.size() - 1;
+      index_.erase(_hash_at(last_index), last_index);
       vector_.pop_back();
     }
   }
 
-  bool push_back(const T& value) {
-    if (set_.insert(value).second) {
-      vector_.push_back(value);
-      return true;
-    }
-    return false;
-  }
+  bool push_back(const T& value) { return _push_back(hash_(value), value); }
 
   bool push_back(T&& value) {
-    if (set_.insert(value).second) {
-      vector_.push_back(std::move(value));
-      return true;
+    return _push_back(hash_(value), std::move(value));
+  }
+
+  // Appends the element owned by nh unless an equal element is present,
+  // reusing its hash and index entry. If it is not inserted, the result
+  // points at the equal element and hands nh back. An empty nh inserts
+  // nothing.
+  insert_return_type insert(node_type&& nh) {
+    if (nh.empty()) {
+      return {cend(), false, node_type()};
     }
-    return false;
+    auto p = _find(nh.hash_, nh.value_);
+    if (p != nullptr) {
+      return {cbegin() + *p, false, std::move(nh)};
+    }
+    vector_.push_back(std::move(nh.value_));
+    index_.insert(std::move(nh.entry_), nh.hash_, vector_.size() - 1);
+    nh.reset();
+    return {cend() - 1, true, node_type()};
+  }
+
+  // Appends value like push_back, using a hash the caller already has
+  // instead of calling Hash. Precondition: hash == hash_function()(value).
+  bool insert_with_hash(const T& value, std::size_t hash) {
+    return _push_back(hash, value);
+  }
+
+  bool insert_with_hash(T&& value, std::size_t hash) {
+    return _push_back(hash, std::move(value));
   }
 
 #if __cplusplus >= 202302L
@@ -246,31 +457,36 @@ class vector_of_unique {
   }
 #endif
 
- private:
+  // Appends the elements of [first, last) that are not already present, in
+  // order, and returns how many were appended. Forward ranges are measured
+  // up front so the vector and the index grow at most once, and hashes are
+  // computed a batch at a time before the batch is probed.
   template <class input_it>
-  void _push_back(input_it first, input_it last) {
-    while (first != last) {
-      push_back(*first++);
-    }
-  }
-
-  bool _push_back(const vector_of_unique<T, Hash, KeyEqual>& other) {
-    return _push_back(other.vector_);
+  size_type append_bulk(input_it first, input_it last) {
+    using category = typename std::iterator_traits<input_it>::iterator_category;
+    _reserve_for(first, last, category());
+    return _append_bulk(first, last, _is_batchable<input_it>());
   }
 
-  bool _push_back(const std::vector<T>& other) {
-    bool any_added = false;
-    for (const auto& entry : other) {
-      auto added = push_back(entry);
-      any_added = any_added || added;
-    }
-    return any_added;
+  // Inserts the elements of [first, last) that are not already present
+  // before pos, keeping their order, and returns how many were inserted. The
+  // survivors are appended in bulk and rotated into place, so the tail moves
+  // once and the index is rewritten in a single pass.
+  template <class input_it>
+  size_type insert_bulk(const_iterator pos, input_it first, input_it last) {
+    auto pos_index = static_cast<size_type>(pos - vector_.cbegin());
+    auto old_size = vector_.size();
+    auto inserted = append_bulk(first, last);
+    _rotate_appended(pos_index, old_size);
+    return inserted;
   }
 
- public:
   void swap(vector_of_unique& other) NOEXCEPT_CXX17 {
+    using std::swap;
     vector_.swap(other.vector_);
-    set_.swap(other.set_);
+    index_.swap(other.index_);
+    swap(hash_, other.hash_);
+    swap(eq_, other.eq_);
   }
 
   // Capacity
@@ -278,36 +494,40 @@ class vector_of_unique {
 
   size_type size() const noexcept { return vector_.size(); }
 
+  // Sizes both the vector and the index for at least new_cap elements.
+  void reserve(size_type new_cap) {
+    vector_.reserve(new_cap);
+    index_.reserve(new_cap);
+  }
+
+  size_type capacity() const noexcept { return vector_.capacity(); }
+
+  // Releases unused capacity of the vector and shrinks the index to the
+  // smallest bucket count that keeps the load factor within bounds.
+  void shrink_to_fit() {
+    vector_.shrink_to_fit();
+    index_.rehash(0);
+  }
+
+  // Hash policy
+  size_type bucket_count() const noexcept { return index_.bucket_count(); }
+  float load_factor() const noexcept { return index_.load_factor(); }
+  float max_load_factor() const noexcept { return index_.max_load_factor(); }
+  void max_load_factor(float ml) { index_.max_load_factor(ml); }
+  void rehash(size_type count) { index_.rehash(count); }
+  // Only with the bloom_filter index policy.
+  bloom_stats prefilter_stats() const noexcept { return index_.stats(); }
+
 // Look up
 #if __cplusplus < 202002L
   const_iterator find(const T& x) const {
-    if (set_.count(x) == 0) {
-      return cend();
-    }
-    auto eq = set_.key_eq();
-    auto it = cbegin();
-    while (it != cend()) {
-      if (eq(*it, x)) {
-        return it;
-      }
-      it++;
-    }
-    return cend();
+    auto p = _find(x);
+    return p == nullptr ? cend() : cbegin() + *p;
   }
 #else
   const_iterator find(const T& x) const {
-    if (set_.count(x) == 0) {
-      return cend();
-    }
-    auto eq = set_.key_eq();
-    auto it = cbegin();
-    while (it != cend()) {
-      if (eq(*it, x)) {
-        return it;
-      }
-      it++;
-    }
-    return cend();
+    auto p = _find(x);
+    return p == nullptr ? cend() : cbegin() + *p;
   }
 
   template <class K>
@@ -316,23 +536,13 @@ class vector_of_unique {
       typename KeyEqual::is_transparent;
     }
   const_iterator find(const K& x) const {
-    if (set_.count(x) == 0) {
-      return cend();
-    }
-    auto eq = set_.key_eq();
-    auto it = cbegin();
-    while (it != cend()) {
-      if (eq(*it, x)) {
-        return it;
-      }
-      it++;
-    }
-    return cend();
+    auto p = _find(x);
+    return p == nullptr ? cend() : cbegin() + *p;
   }
 #endif
 
 #if __cplusplus >= 202002L
-  bool contains(const key_type& key) const { return set_.contains(key); }
+  bool contains(const key_type& key) const { return _find(key) != nullptr; }
 
   template <class K>
     requires requires {
@@ -340,7 +550,71 @@ class vector_of_unique {
       typename KeyEqual::is_transparent;
     }
   bool contains(const K& x) const {
-    return set_.contains(x);
+    return _find(x) != nullptr;
+  }
+#endif
+
+  // Finds x like find, using a hash the caller already has instead of
+  // calling Hash. Precondition: hash == hash_function()(x).
+  const_iterator find_with_hash(const T& x, std::size_t hash) const {
+    auto p = _find(hash, x);
+    return p == nullptr ? cend() : cbegin() + *p;
+  }
+
+  // Batched lookups. Keys are hashed a batch at a time, so probes no longer
+  // wait on hashing, and the index starts loading the entries of the next
+  // few keys while one is probed, so their cache misses overlap. This pays
+  // off for keys that are costly to hash, such as strings; keys as cheap as
+  // int already overlap in a plain loop. node_index gives no way to load its
+  // buckets ahead.
+
+  // Sets bit i % 64 of out[i / 64] if the i-th key of [first, last) is
+  // present and clears it otherwise. out must hold (n + 63) / 64 words for
+  // n keys.
+  template <class forward_it>
+  void contains_batch(forward_it first, forward_it last,
+                      std::uint64_t* out) const {
+    // Words are built in a local so the stores do not chain the lookups.
+    std::uint64_t word = 0;
+    auto n = _find_batch(first, last, [&](size_type i, const size_type* p) {
+      word |= std::uint64_t{p != nullptr} << (i % 64);
+      if (i % 64 == 63) {
+        out[i / 64] = word;
+        word = 0;
+      }
+    });
+    if (n % 64 != 0) {
+      out[n / 64] = word;
+    }
+  }
+
+  // Writes find(key) for each key of [first, last) through out, and returns
+  // out past the last result.
+  template <class forward_it, class output_it>
+  output_it find_batch(forward_it first, forward_it last,
+                       output_it out) const {
+    _find_batch(first, last, [&](size_type, const size_type* p) {
+      *out = p == nullptr ? cend() : cbegin() + *p;
+      ++out;
+    });
+    return out;
+  }
+
+  // Returns the position of key, or npos if it is not present.
+  size_type index_of(const key_type& key) const {
+    auto p = _find(key);
+    return p == nullptr ? npos : *p;
+  }
+
+#if __cplusplus >= 202002L
+  template <class K>
+    requires requires {
+      typename Hash::is_transparent;
+      typename KeyEqual::is_transparent;
+    }
+  size_type index_of(const K& x) const {
+    auto p = _find(x);
+    return p == nullptr ? npos : *p;
   }
 #endif
 
@@ -367,21 +641,332 @@ class vector_of_unique {
   // Destructor
   ~vector_of_unique() = default;
 
+  // Observers
+  allocator_type get_allocator() const noexcept {
+    return vector_.get_allocator();
+  }
+  hasher hash_function() const { return hash_; }
+  key_equal key_eq() const { return eq_; }
+
   // Get member variables
   const VectorType& vector() const { return vector_; }
-  const UnorderedSetType& set() const { return set_; }
+  SetViewType set() const noexcept { return SetViewType(*this); }
+
+  // Moves the sequence out, without copying it, and leaves this container
+  // empty.
+  VectorType release() && {
+    VectorType seq(std::move(vector_));
+    clear();
+    return seq;
+  }
 
  private:
+  using AllocTraits = std::allocator_traits<Allocator>;
+  using PositionVector =
+      std::vector<size_type,
+                  typename AllocTraits::template rebind_alloc<size_type>>;
+  using PositionMask =
+      std::vector<bool, typename AllocTraits::template rebind_alloc<bool>>;
+
+  friend SetViewType;
+
+  template <class K>
+  const size_type* _find(std::size_t hash, const K& key) const {
+    return index_.find(hash,
+                       [&](size_type pos) { return eq_(vector_[pos], key); });
+  }
+
+  template <class K>
+  const size_type* _find(const K& key) const {
+    return _find(hash_(key), key);
+  }
+
+  // Moves every indexed position at or after from up by count.
+  void _open_gap(size_type from, size_type count) {
+    if (from >= vector_.size()) {
+      return;
+    }
+    index_.remap([from, count](size_type& p) {
+      if (p >= from) {
+        p += count;
+      }
+      return true;
+    });
+  }
+
+  // Hash of the element at pos, taken from the index when it caches hashes.
+  std::size_t _hash_at(size_type pos) const {
+    return index_.hash_at(pos, [&] { return hash_(vector_[pos]); });
+  }
+
+  // Moves every indexed position at or after from down by count.
+  void _close_gap(size_type from, size_type count) {
+    if (from >= vector_.size()) {
+      return;
+    }
+    index_.remap([from, count](size_type& p) {
+      if (p >= from) {
+        p -= count;
+      }
+      return true;
+    });
+  }
+
+  // Indexes the element just appended, or removes it again if it duplicates
+  // an existing element or indexing it throws.
+  bool _index_back() {
+    try {
+      const auto& value = vector_.back();
+      auto h = hash_(value);
+      if (_find(h, value) == nullptr) {
+        index_.insert(h, vector_.size() - 1);
+        return true;
+      }
+    } catch (...) {
+      vector_.pop_back();
+      throw;
+    }
+    vector_.pop_back();
+    return false;
+  }
+
+  template <class... Args>
+  bool _emplace_back(Args&&... args) {
+    if (vector_.size() == vector_.capacity()) {
+      T value(std::forward<Args>(args)...);
+      auto h = hash_(value);
+      return _push_back(h, std::move(value));
+    }
+    vector_.emplace_back(std::forward<Args>(args)...);
+    return _index_back();
+  }
+
+  // Swap-and-pop: hash is the hash of the element at pos_index.
+  void _unordered_erase(size_type pos_index, std::size_t hash) {
+    auto last_index = vector_.size() - 1;
+    index_.erase(hash, pos_index);
+    if (pos_index != last_index) {
+      index_.relocate(_hash_at(last_index), last_index, pos_index);
+      vector_[pos_index] = std::move(vector_.back());
+    }
+    vector_.pop_back();
+  }
+
+  // Removes every position for which drop(pos) returns true, like
+  // remove_if. drop is called once per position, in order, before any
+  // element moves, so an exception from drop leaves the container unchanged.
+  template <class Drop>
+  size_type _remove_positions(Drop drop) {
+    PositionVector moved_to(vector_.size(), npos, vector_.get_allocator());
+    size_type out = 0;
+    for (size_type in = 0; in < vector_.size(); ++in) {
+      if (!drop(in)) {
+        moved_to[in] = out++;
+      }
+    }
+
+    auto removed = vector_.size() - out;
+    if (removed != 0) {
+      for (size_type in = 0; in < vector_.size(); ++in) {
+        if (moved_to[in] != npos && moved_to[in] != in) {
+          vector_[moved_to[in]] = std::move(vector_[in]);
+        }
+      }
+      index_.remap([&moved_to](size_type& p) {
+        p = moved_to[p];
+        return p != npos;
+      });
+      vector_.erase(vector_.begin() + out, vector_.end());
+    }
+    return removed;
+  }
+
+  // Marks the positions of the elements of other that this container holds.
+  template <class Container>
+  PositionMask _positions_of(const Container& other) const {
+    PositionMask found(vector_.size(), false, vector_.get_allocator());
+    for (const auto& x : other) {
+      auto p = _find(x);
+      if (p != nullptr) {
+        found[*p] = true;
+      }
+    }
+    return found;
+  }
+
+  // Calls f(i, _find(key)) for the i-th key of [first, last), in order,
+  // hashing a batch ahead and prefetching prefetch_distance keys ahead.
+  // Returns the number of keys.
+  template <class forward_it, class F>
+  size_type _find_batch(forward_it first, forward_it last, F f) const {
+    std::array<std::size_t, bulk_batch_size> hashes;
+    size_type i = 0;
+    while (first != last) {
+      std::size_t n = 0;
+      for (auto it = first; it != last && n < bulk_batch_size; ++it, ++n) {
+        hashes[n] = hash_(*it);
+      }
+      for (std::size_t k = 0; k < std::min(n, std::size_t{prefetch_distance});
+           ++k) {
+        index_.prefetch(hashes[k]);
+      }
+      for (std::size_t k = 0; k < n; ++k, ++first, ++i) {
+        if (k + prefetch_distance < n) {
+          index_.prefetch(hashes[k + prefetch_distance]);
+        }
+        f(i, _find(hashes[k], *first));
+      }
+    }
+    return i;
+  }
+
+  // Number of hashes append_bulk and the batched lookups compute ahead of
+  // probing the index.
+  static constexpr std::size_t bulk_batch_size = 64;
+
+  // Number of keys ahead of the one being probed whose index entries are
+  // being loaded. Loading a whole batch at once would exceed the misses a
+  // core can keep in flight.
+  static constexpr std::size_t prefetch_distance = 8;
+
+  // Hashes can only be computed ahead for multi-pass ranges whose elements
+  // already are T; anything else is converted and hashed one at a time.
+  template <class It>
+  using _is_batchable = std::integral_constant<
+      bool, std::is_base_of<std::forward_iterator_tag,
+                            typename std::iterator_traits<
+                                It>::iterator_category>::value &&
+                std::is_same<typename std::decay<decltype(*std::declval<
+                                 It&>())>::type,
+                             T>::value>;
+
+  template <class input_it>
+  void _reserve_for(input_it, input_it, std::input_iterator_tag) {}
+
+  template <class forward_it>
+  void _reserve_for(forward_it first, forward_it last,
+                    std::forward_iterator_tag) {
+    _reserve_more(static_cast<size_type>(std::distance(first, last)));
+  }
+
+  // Makes room for count more elements. Growth is geometric, as in
+  // push_back, so a run of small bulk inserts reallocates the vector and
+  // rehashes the index only O(log n) times.
+  void _reserve_more(size_type count) {
+    auto needed = vector_.size() + count;
+    if (needed > vector_.capacity()) {
+      vector_.reserve(std::max(needed, 2 * vector_.capacity()));
+    }
+    auto room = static_cast<size_type>(
+        static_cast<double>(index_.bucket_count()) * index_.max_load_factor());
+    if (needed > room) {
+      index_.reserve(std::max(needed, 2 * room));
+    }
+  }
+
+  template <class input_it>
+  size_type _append_bulk(input_it first, input_it last, std::false_type) {
+    size_type appended = 0;
+    for (; first != last; ++first) {
+      appended += push_back(*first) ? 1 : 0;
+    }
+    return appended;
+  }
+
+  template <class forward_it>
+  size_type _append_bulk(forward_it first, forward_it last, std::true_type) {
+    std::array<std::size_t, bulk_batch_size> hashes;
+    size_type appended = 0;
+    while (first != last) {
+      std::size_t n = 0;
+      for (auto it = first; it != last && n < bulk_batch_size; ++it, ++n) {
+        hashes[n] = hash_(*it);
+      }
+      for (std::size_t i = 0; i < std::min(n, std::size_t{prefetch_distance});
+           ++i) {
+        index_.prefetch(hashes[i]);
+      }
+      for (std::size_t i = 0; i < n; ++i, ++first) {
+        if (i + prefetch_distance < n) {
+          index_.prefetch(hashes[i + prefetch_distance]);
+        }
+        appended += _push_back(hashes[i], *first) ? 1 : 0;
+      }
+    }
+    return appended;
+  }
+
+  // Rotates the elements appended after old_size to pos_index, keeping
+  // their order, and rewrites the index in a single pass.
+  void _rotate_appended(size_type pos_index, size_type old_size) {
+    auto inserted = vector_.size() - old_size;
+    if (inserted == 0 || pos_index == old_size) {
+      return;
+    }
+    std::rotate(vector_.begin() + pos_index, vector_.begin() + old_size,
+                vector_.end());
+    index_.remap([pos_index, old_size, inserted](size_type& p) {
+      if (p >= old_size) {
+        p -= old_size - pos_index;
+      } else if (p >= pos_index) {
+        p += inserted;
+      }
+      return true;
+    });
+  }
+
+  template <class V>
+  bool _push_back(std::size_t hash, V&& value) {
+    if (_find(hash, value) != nullptr) {
+      return false;
+    }
+    vector_.push_back(std::forward<V>(value));
+    try {
+      index_.insert(hash, vector_.size() - 1);
+    } catch (...) {
+      vector_.pop_back();
+      throw;
+    }
+    return true;
+  }
+
+  template <class V>
+  const_iterator _insert(const_iterator pos, std::size_t hash, V&& value) {
+    auto pos_index = static_cast<size_type>(pos - vector_.cbegin());
+    _open_gap(pos_index, 1);
+    auto it = vector_.insert(pos, std::forward<V>(value));
+    index_.insert(hash, pos_index);
+    return it;
+  }
+
   VectorType vector_;
-  UnorderedSetType set_;
+  // Maps element hashes to positions in vector_, so each element is stored
+  // only once.
+  IndexType index_;
+  Hash hash_;
+  KeyEqual eq_;
 };  // class vector_of_unique
 
+#if __cplusplus < 201703L
+template <class T, class Hash, class KeyEqual, class Allocator,
+          class IndexPolicy>
+constexpr typename vector_of_unique<T, Hash, KeyEqual, Allocator,
+                                    IndexPolicy>::size_type
+    vector_of_unique<T, Hash, KeyEqual, Allocator, IndexPolicy>::npos;
+template <class T, class Hash, class KeyEqual, class Allocator,
+          class IndexPolicy>
+constexpr std::size_t vector_of_unique<T, Hash, KeyEqual, Allocator,
+                                       IndexPolicy>::bulk_batch_size;
+#endif
+
 // Non-member function
 #if __cplusplus >= 202002L && __cplusplus < 202600L
 template <class T, class Hash = std::hash<T>, class KeyEqual = std::equal_to<T>,
+          class Allocator = std::allocator<T>, class IndexPolicy = node_index,
           class U>
-typename vector_of_unique<T, Hash, KeyEqual>::size_type erase(
-    vector_of_unique<T, Hash, KeyEqual>& c, const U& value) {
+typename vector_of_unique<T, Hash, KeyEqual, Allocator, IndexPolicy>::size_type
+erase(vector_of_unique<T, Hash, KeyEqual, Allocator, IndexPolicy>& c,
+      const U& value) {
   auto it = c.find(value);
   if (it != c.cend()) {
     c.erase(it);
@@ -391,9 +976,11 @@ typename vector_of_unique<T, Hash, KeyEqual>::size_type erase(
 }
 #else
 template <class T, class Hash = std::hash<T>, class KeyEqual = std::equal_to<T>,
+          class Allocator = std::allocator<T>, class IndexPolicy = node_index,
           class U = T>
-typename vector_of_unique<T, Hash, KeyEqual>::size_type erase(
-    vector_of_unique<T, Hash, KeyEqual>& c, const U& value) {
+typename vector_of_unique<T, Hash, KeyEqual, Allocator, IndexPolicy>::size_type
+erase(vector_of_unique<T, Hash, KeyEqual, Allocator, IndexPolicy>& c,
+      const U& value) {
   auto it = c.find(value);
   if (it != c.cend()) {
     c.erase(it);
@@ -404,64 +991,81 @@ typename vector_of_unique<T, Hash, KeyEqual>::size_type erase(
 #endif
 
 template <class T, class Hash = std::hash<T>, class KeyEqual = std::equal_to<T>,
+          class Allocator = std::allocator<T>, class IndexPolicy = node_index,
           class Pred>
-typename vector_of_unique<T, Hash, KeyEqual>::size_type erase_if(
-    vector_of_unique<T, Hash, KeyEqual>& c, Pred pred) {
-  auto it = c.cbegin();
-  typename vector_of_unique<T, Hash, KeyEqual>::size_type r = 0;
-  while (it != c.cend()) {
-    if (pred(*it)) {
-      it = c.erase(it);
-      ++r;
-    } else {
-      ++it;
-    }
-  }
-  return r;
+typename vector_of_unique<T, Hash, KeyEqual, Allocator, IndexPolicy>::size_type
+erase_if(vector_of_unique<T, Hash, KeyEqual, Allocator, IndexPolicy>& c,
+         Pred pred) {
+  return c.remove_if(pred);
 }
 
 // Operators
-template <class T, class Hash = std::hash<T>, class KeyEqual = std::equal_to<T>>
-bool operator==(const vector_of_unique<T, Hash, KeyEqual>& lhs,
-                const vector_of_unique<T, Hash, KeyEqual>& rhs) {
+template <class T, class Hash = std::hash<T>, class KeyEqual = std::equal_to<T>,
+          class Allocator = std::allocator<T>, class IndexPolicy = node_index>
+bool operator==(
+    const vector_of_unique<T, Hash, KeyEqual, Allocator, IndexPolicy>& lhs,
+    const vector_of_unique<T, Hash, KeyEqual, Allocator, IndexPolicy>& rhs) {
   return (lhs.vector() == rhs.vector());
 }
 
 #if __cplusplus < 202002L
-template <class T, class Hash = std::hash<T>, class KeyEqual = std::equal_to<T>>
-bool operator!=(const vector_of_unique<T, Hash, KeyEqual>& lhs,
-                const vector_of_unique<T, Hash, KeyEqual>& rhs) {
+template <class T, class Hash = std::hash<T>, class KeyEqual = std::equal_to<T>,
+          class Allocator = std::allocator<T>, class IndexPolicy = node_index>
+bool operator!=(
+    const vector_of_unique<T, Hash, KeyEqual, Allocator, IndexPolicy>& lhs,
+    const vector_of_unique<T, Hash, KeyEqual, Allocator, IndexPolicy>& rhs) {
   return (lhs.vector() != rhs.vector());
 }
 
-template <class T, class Hash = std::hash<T>, class KeyEqual = std::equal_to<T>>
-bool operator<(const vector_of_unique<T, Hash, KeyEqual>& lhs,
-               const vector_of_unique<T, Hash, KeyEqual>& rhs) {
+template <class T, class Hash = std::hash<T>, class KeyEqual = std::equal_to<T>,
+          class Allocator = std::allocator<T>, class IndexPolicy = node_index>
+bool operator<(
+    const vector_of_unique<T, Hash, KeyEqual, Allocator, IndexPolicy>& lhs,
+    const vector_of_unique<T, Hash, KeyEqual, Allocator, IndexPolicy>& rhs) {
   return (lhs.vector() < rhs.vector());
 }
 
-template <class T, class Hash = std::hash<T>, class KeyEqual = std::equal_to<T>>
-bool operator<=(const vector_of_unique<T, Hash, KeyEqual>& lhs,
-                const vector_of_unique<T, Hash, KeyEqual>& rhs) {
+template <class T, class Hash = std::hash<T>, class KeyEqual = std::equal_to<T>,
+          class Allocator = std::allocator<T>, class IndexPolicy = node_index>
+bool operator<=(
+    const vector_of_unique<T, Hash, KeyEqual, Allocator, IndexPolicy>& lhs,
+    const vector_of_unique<T, Hash, KeyEqual, Allocator, IndexPolicy>& rhs) {
   return (lhs.vector() <= rhs.vector());
 }
 
-template <class T, class Hash = std::hash<T>, class KeyEqual = std::equal_to<T>>
-bool operator>(const vector_of_unique<T, Hash, KeyEqual>& lhs,
-               const vector_of_unique<T, Hash, KeyEqual>& rhs) {
+template <class T, class Hash = std::hash<T>, class KeyEqual = std::equal_to<T>,
+          class Allocator = std::allocator<T>, class IndexPolicy = node_index>
+bool operator>(
+    const vector_of_unique<T, Hash, KeyEqual, Allocator, IndexPolicy>& lhs,
+    const vector_of_unique<T, Hash, KeyEqual, Allocator, IndexPolicy>& rhs) {
   return (lhs.vector() > rhs.vector());
 }
 
-template <class T, class Hash = std::hash<T>, class KeyEqual = std::equal_to<T>>
-bool operator>=(const vector_of_unique<T, Hash, KeyEqual>& lhs,
-                const vector_of_unique<T, Hash, KeyEqual>& rhs) {
+template <class T, class Hash = std::hash<T>, class KeyEqual = std::equal_to<T>,
+          class Allocator = std::allocator<T>, class IndexPolicy = node_index>
+bool operator>=(
+    const vector_of_unique<T, Hash, KeyEqual, Allocator, IndexPolicy>& lhs,
+    const vector_of_unique<T, Hash, KeyEqual, Allocator, IndexPolicy>& rhs) {
   return (lhs.vector() >= rhs.vector());
 }
 #else
-template <class T, class Hash = std::hash<T>, class KeyEqual = std::equal_to<T>>
-auto operator<=>(const vector_of_unique<T, Hash, KeyEqual>& lhs,
-                 const vector_of_unique<T, Hash, KeyEqual>& rhs) {
+template <class T, class Hash = std::hash<T>, class KeyEqual = std::equal_to<T>,
+          class Allocator = std::allocator<T>, class IndexPolicy = node_index>
+auto operator<=>(
+    const vector_of_unique<T, Hash, KeyEqual, Allocator, IndexPolicy>& lhs,
+    const vector_of_unique<T, Hash, KeyEqual, Allocator, IndexPolicy>& rhs) {
   return (lhs.vector() <=> rhs.vector());
 }
 #endif
+
+#if __cplusplus >= 201703L && __has_include(<memory_resource>)
+namespace pmr {
+template <class T, class Hash = std::hash<T>, class KeyEqual = std::equal_to<T>,
+          class IndexPolicy = node_index>
+using vector_of_unique =
+    containerofunique::vector_of_unique<T, Hash, KeyEqual,
+                                        std::pmr::polymorphic_allocator<T>,
+                                        IndexPolicy>;
+}  // namespace pmr
+#endif
 };  // namespace containerofunique
\ No newline at end of file
@@ -0,0 +1,279 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "boundeddequeofunique.h"
+
+using namespace containerofunique;
+
+template <class C>
+std::vector<typename C::value_type> contents(const C& c) {
+  return std::vector<typename C::value_type>(c.begin(), c.end());
+}
+
+TEST(BoundedDequeOfUniqueTest, ConstructorWithCapacity) {
+  bounded_deque_of_unique<int> bdou(3);
+  EXPECT_TRUE(bdou.empty());
+  EXPECT_FALSE(bdou.full());
+  EXPECT_EQ(bdou.capacity(), 3u);
+  EXPECT_EQ(bdou.begin(), bdou.end());
+}
+
+TEST(BoundedDequeOfUniqueTest, ConstructorKeepsLastElements) {
+  bounded_deque_of_unique<int> bdou(3, {1, 2, 2, 3, 4});
+  EXPECT_TRUE(bdou.full());
+  EXPECT_EQ(contents(bdou), std::vector<int>({2, 3, 4}));
+  EXPECT_EQ(bdou.front(), 2);
+  EXPECT_EQ(bdou.back(), 4);
+}
+
+TEST(BoundedDequeOfUniqueTest, Fifo_PushBackEvictsFront) {
+  bounded_deque_of_unique<int> bdou(3);
+  for (int i = 1; i <= 5; ++i) {
+    EXPECT_TRUE(bdou.push_back(i));
+  }
+  EXPECT_EQ(contents(bdou), std::vector<int>({3, 4, 5}));
+  EXPECT_EQ(bdou.find(2), bdou.cend());
+  EXPECT_FALSE(bdou.push_back(3));
+  EXPECT_EQ(contents(bdou), std::vector<int>({3, 4, 5}));
+  EXPECT_EQ(bdou.size(), 3u);
+}
+
+TEST(BoundedDequeOfUniqueTest, Fifo_PushFrontEvictsBack) {
+  bounded_deque_of_unique<int> bdou(3, {1, 2, 3});
+  EXPECT_TRUE(bdou.push_front(0));
+  EXPECT_EQ(contents(bdou), std::vector<int>({0, 1, 2}));
+  EXPECT_FALSE(bdou.push_front(2));
+  EXPECT_EQ(contents(bdou), std::vector<int>({0, 1, 2}));
+}
+
+TEST(BoundedDequeOfUniqueTest, Lru_RepushMovesToBack) {
+  bounded_deque_of_unique<int, lru_eviction> bdou(3, {1, 2, 3});
+  EXPECT_FALSE(bdou.push_back(1));
+  EXPECT_EQ(contents(bdou), std::vector<int>({2, 3, 1}));
+  EXPECT_TRUE(bdou.push_back(4));
+  EXPECT_EQ(contents(bdou), std::vector<int>({3, 1, 4}));
+  EXPECT_FALSE(bdou.push_back(4));
+  EXPECT_EQ(contents(bdou), std::vector<int>({3, 1, 4}));
+}
+
+TEST(BoundedDequeOfUniqueTest, Lru_RepushFrontMovesToFront) {
+  bounded_deque_of_unique<int, lru_eviction> bdou(3, {1, 2, 3});
+  EXPECT_FALSE(bdou.push_front(3));
+  EXPECT_EQ(contents(bdou), std::vector<int>({3, 1, 2}));
+  EXPECT_TRUE(bdou.push_front(0));
+  EXPECT_EQ(contents(bdou), std::vector<int>({0, 3, 1}));
+}
+
+TEST(BoundedDequeOfUniqueTest, PopAndErase) {
+  bounded_deque_of_unique<int> bdou(5, {1, 2, 3, 4, 5});
+  bdou.pop_front();
+  bdou.pop_back();
+  EXPECT_EQ(contents(bdou), std::vector<int>({2, 3, 4}));
+  auto it = bdou.erase(bdou.find(3));
+  EXPECT_EQ(*it, 4);
+  EXPECT_EQ(erase(bdou, 4), 1u);
+  EXPECT_EQ(erase(bdou, 4), 0u);
+  EXPECT_EQ(contents(bdou), std::vector<int>({2}));
+  EXPECT_TRUE(bdou.push_back(3));
+  EXPECT_TRUE(bdou.push_back(4));
+  EXPECT_EQ(erase_if(bdou, [](int x) { return x % 2 == 0; }), 2u);
+  EXPECT_EQ(contents(bdou), std::vector<int>({3}));
+  bdou.clear();
+  EXPECT_TRUE(bdou.empty());
+  bdou.pop_front();
+  bdou.pop_back();
+  EXPECT_TRUE(bdou.push_back(2));
+  EXPECT_EQ(bdou.front(), 2);
+}
+
+TEST(BoundedDequeOfUniqueTest, Iterators) {
+  bounded_deque_of_unique<int> bdou(4, {1, 2, 3});
+  EXPECT_EQ(std::vector<int>(bdou.rbegin(), bdou.rend()),
+            std::vector<int>({3, 2, 1}));
+  auto it = bdou.end();
+  --it;
+  EXPECT_EQ(*it, 3);
+  EXPECT_EQ(*bdou.find(2), 2);
+  EXPECT_EQ(bdou.find(7), bdou.end());
+#if __cplusplus >= 202002L
+  EXPECT_TRUE(bdou.contains(1));
+  EXPECT_FALSE(bdou.contains(7));
+#endif
+}
+
+TEST(BoundedDequeOfUniqueTest, CopyMoveAndSwap) {
+  bounded_deque_of_unique<std::string, lru_eviction> bdou(2, {"a", "b"});
+  auto copy = bdou;
+  EXPECT_EQ(copy, bdou);
+  copy.push_back("c");
+  EXPECT_NE(copy, bdou);
+  EXPECT_EQ(contents(copy), std::vector<std::string>({"b", "c"}));
+
+  auto moved = std::move(copy);
+  EXPECT_EQ(contents(moved), std::vector<std::string>({"b", "c"}));
+  EXPECT_EQ(moved.capacity(), 2u);
+
+  bdou.swap(moved);
+  EXPECT_EQ(contents(bdou), std::vector<std::string>({"b", "c"}));
+  EXPECT_EQ(contents(moved), std::vector<std::string>({"a", "b"}));
+
+  moved = bdou;
+  EXPECT_EQ(moved, bdou);
+  EXPECT_TRUE(moved.push_back("a"));
+  EXPECT_EQ(contents(moved), std::vector<std::string>({"c", "a"}));
+}
+
+TEST(BoundedDequeOfUniqueTest, ZeroCapacityHoldsNothing) {
+  bounded_deque_of_unique<int> bdou(0);
+  EXPECT_FALSE(bdou.push_back(1));
+  EXPECT_FALSE(bdou.push_front(1));
+  EXPECT_TRUE(bdou.empty());
+  EXPECT_TRUE(bdou.full());
+}
+
+TEST(BoundedDequeOfUniqueTest, NodeIndexPolicy) {
+  bounded_deque_of_unique<int, lru_eviction, std::hash<int>,
+                          std::equal_to<int>, std::allocator<int>, node_index>
+      bdou(2, {1, 2});
+  EXPECT_FALSE(bdou.push_back(1));
+  EXPECT_TRUE(bdou.push_back(3));
+  EXPECT_EQ(contents(bdou), std::vector<int>({1, 3}));
+}
+
+TEST(BoundedDequeOfUniqueTest, MoveOnlyElements) {
+  bounded_deque_of_unique<std::unique_ptr<int>> bdou(2);
+  bdou.push_back(std::make_unique<int>(1));
+  bdou.push_back(std::make_unique<int>(2));
+  bdou.push_front(std::make_unique<int>(0));
+  EXPECT_EQ(bdou.size(), 2u);
+  EXPECT_EQ(*bdou.front(), 0);
+  EXPECT_EQ(*bdou.back(), 1);
+}
+
+TEST(BoundedDequeOfUniqueTest, SlidingWindowKeepsLastElements) {
+  bounded_deque_of_unique<int> bdou(1000);
+  for (int i = 0; i < 100000; ++i) {
+    bdou.push_back(i);
+    EXPECT_FALSE(bdou.push_back(i > 10 ? i - 10 : i));
+  }
+  EXPECT_EQ(bdou.size(), 1000u);
+  int expected = 99000;
+  for (int v : bdou) {
+    EXPECT_EQ(v, expected++);
+  }
+  EXPECT_EQ(bdou.find(98999), bdou.cend());
+}
+
+// Int wrapper whose copy constructor throws while armed.
+struct ThrowingCopy {
+  static bool armed;
+  int v;
+
+  explicit ThrowingCopy(int value) : v(value) {}
+  ThrowingCopy(const ThrowingCopy& other) : v(other.v) {
+    if (armed) {
+      throw std::runtime_error("copy");
+    }
+  }
+  bool operator==(const ThrowingCopy& other) const { return v == other.v; }
+};
+
+bool ThrowingCopy::armed = false;
+
+struct ThrowingCopyHash {
+  std::size_t operator()(const ThrowingCopy& x) const {
+    return std::hash<int>()(x.v);
+  }
+};
+
+TEST(BoundedDequeOfUniqueTest, ThrowingPushOnFullLeavesContainerIntact) {
+  bounded_deque_of_unique<ThrowingCopy, fifo_eviction, ThrowingCopyHash> bdou(
+      3);
+  for (int i = 1; i <= 3; ++i) {
+    bdou.push_back(ThrowingCopy(i));
+  }
+  ThrowingCopy four(4);
+  ThrowingCopy::armed = true;
+  EXPECT_THROW(bdou.push_back(four), std::runtime_error);
+  EXPECT_THROW(bdou.push_front(four), std::runtime_error);
+  ThrowingCopy::armed = false;
+  EXPECT_EQ(bdou.size(), 3u);
+  int expected = 1;
+  for (const auto& x : bdou) {
+    EXPECT_EQ(x.v, expected++);
+  }
+  EXPECT_NE(bdou.find(ThrowingCopy(1)), bdou.cend());
+  EXPECT_NE(bdou.find(ThrowingCopy(3)), bdou.cend());
+  EXPECT_TRUE(bdou.push_back(four));
+  EXPECT_EQ(bdou.front().v, 2);
+  EXPECT_EQ(bdou.back().v, 4);
+}
+
+#if __cplusplus >= 201703L
+// memory_resource that counts the allocations made through it.
+class CountingResource : public std::pmr::memory_resource {
+ public:
+  size_t allocations = 0;
+
+ private:
+  void* do_allocate(size_t bytes, size_t alignment) override {
+    ++allocations;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+  void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+  }
+  bool do_is_equal(
+      const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+};
+
+TEST(BoundedDequeOfUniqueTest, SteadyStateDoesNotAllocate) {
+  CountingResource resource;
+  bounded_deque_of_unique<int, lru_eviction, std::hash<int>,
+                          std::equal_to<int>,
+                          std::pmr::polymorphic_allocator<int>>
+      bdou(512, &resource);
+  auto allocations = resource.allocations;
+  for (int i = 0; i < 100000; ++i) {
+    bdou.push_back(i % 1500);
+    bdou.push_front(i % 700);
+  }
+  EXPECT_EQ(resource.allocations, allocations);
+  EXPECT_EQ(bdou.size(), 512u);
+}
+#endif
+
+TEST(BoundedDequeOfUniqueTest, CachedHashPolicy) {
+  bounded_deque_of_unique<int, lru_eviction, std::hash<int>,
+                          std::equal_to<int>, std::allocator<int>,
+                          cached_hash<flat_index>>
+      bdou(100);
+  for (int i = 0; i < 10000; ++i) {
+    bdou.push_back(i % 150);
+    bdou.push_front(i % 70);
+    auto it = bdou.find(i % 150);
+    if (i % 7 == 0 && it != bdou.end()) {
+      bdou.erase(it);
+    }
+  }
+  auto copy = bdou;
+  EXPECT_EQ(copy, bdou);
+  for (int v : bdou) {
+    EXPECT_EQ(*copy.find(v), v);
+  }
+  while (!copy.empty()) {
+    copy.pop_back();
+  }
+  EXPECT_TRUE(copy.push_back(1));
+}
@@ -0,0 +1,171 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "concurrentdedupqueue.h"
+
+using namespace containerofunique;
+
+TEST(ConcurrentDedupQueueTest, PushRejectsPendingItems) {
+  // One shard, so that items pop in strict FIFO order.
+  concurrent_dedup_queue<std::string> q(1);
+  EXPECT_EQ(q.shard_count(), 1u);
+  EXPECT_TRUE(q.empty());
+  EXPECT_TRUE(q.push("a"));
+  EXPECT_TRUE(q.push("b"));
+  EXPECT_FALSE(q.push("a"));
+  EXPECT_EQ(q.size(), 2u);
+
+  std::string out;
+  EXPECT_TRUE(q.try_pop(out));
+  EXPECT_EQ(out, "a");
+  // Popped, so it may be enqueued again, behind "b".
+  EXPECT_TRUE(q.push("a"));
+  EXPECT_TRUE(q.pop(out));
+  EXPECT_EQ(out, "b");
+  EXPECT_TRUE(q.pop(out));
+  EXPECT_EQ(out, "a");
+  EXPECT_FALSE(q.try_pop(out));
+  EXPECT_EQ(out, "a");
+}
+
+TEST(ConcurrentDedupQueueTest, PopN) {
+  concurrent_dedup_queue<int> q(1);
+  for (int i : {1, 2, 3, 2, 4, 5}) {
+    q.push(i);
+  }
+  std::vector<int> out;
+  EXPECT_EQ(q.pop_n(std::back_inserter(out), 3), 3u);
+  EXPECT_EQ(out, std::vector<int>({1, 2, 3}));
+  EXPECT_EQ(q.try_pop_n(std::back_inserter(out), 10), 2u);
+  EXPECT_EQ(out, std::vector<int>({1, 2, 3, 4, 5}));
+  EXPECT_EQ(q.try_pop_n(std::back_inserter(out), 10), 0u);
+  EXPECT_TRUE(q.push(1));
+}
+
+TEST(ConcurrentDedupQueueTest, Sharded_RejectsPendingItemsAndMovesOut) {
+  concurrent_dedup_queue<std::unique_ptr<int>> q(5);
+  EXPECT_EQ(q.shard_count(), 8u);
+  std::vector<int*> raw;
+  for (int i = 0; i < 100; ++i) {
+    auto p = std::make_unique<int>(i);
+    raw.push_back(p.get());
+    EXPECT_TRUE(q.push(std::move(p)));
+  }
+  EXPECT_EQ(q.size(), 100u);
+
+  // Every item pops exactly once, as the object that was pushed.
+  std::vector<std::unique_ptr<int>> out;
+  EXPECT_EQ(q.try_pop_n(std::back_inserter(out), 60), 60u);
+  EXPECT_EQ(q.size(), 40u);
+  std::unique_ptr<int> last;
+  while (q.try_pop(last)) {
+    out.push_back(std::move(last));
+  }
+  EXPECT_TRUE(q.empty());
+  ASSERT_EQ(out.size(), 100u);
+  std::vector<int> seen(100, 0);
+  for (const auto& p : out) {
+    EXPECT_EQ(p.get(), raw[static_cast<std::size_t>(*p)]);
+    ++seen[static_cast<std::size_t>(*p)];
+  }
+  EXPECT_EQ(seen, std::vector<int>(100, 1));
+
+  concurrent_dedup_queue<int> ints(8);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_TRUE(ints.push(i));
+    EXPECT_FALSE(ints.push(i));
+  }
+  EXPECT_EQ(ints.size(), 100u);
+}
+
+TEST(ConcurrentDedupQueueTest, CloseWakesConsumersAndDrains) {
+  concurrent_dedup_queue<int> q;
+  q.push(1);
+  std::atomic<int> finished{0};
+  std::vector<std::thread> consumers;
+  for (int t = 0; t < 3; ++t) {
+    consumers.emplace_back([&] {
+      int v;
+      while (q.pop(v)) {
+      }
+      ++finished;
+    });
+  }
+  q.close();
+  for (auto& c : consumers) {
+    c.join();
+  }
+  EXPECT_EQ(finished.load(), 3);
+  EXPECT_TRUE(q.closed());
+  EXPECT_TRUE(q.empty());
+  EXPECT_FALSE(q.push(2));
+  std::vector<int> out;
+  EXPECT_EQ(q.pop_n(std::back_inserter(out), 4), 0u);
+}
+
+TEST(ConcurrentDedupQueueTest, ProducersAndConsumers) {
+  constexpr int producers = 4;
+  constexpr int consumers = 4;
+  constexpr int ids = 500;
+  constexpr int rounds = 200;
+  concurrent_dedup_queue<int> q(8);
+  std::atomic<long> pushed{0};
+  std::atomic<long> popped{0};
+  std::vector<std::atomic<int>> pops(ids);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < consumers; ++t) {
+    threads.emplace_back([&, t] {
+      std::vector<int> batch;
+      for (;;) {
+        batch.clear();
+        if (t % 2 == 0) {
+          int v;
+          if (!q.pop(v)) {
+            break;
+          }
+          batch.push_back(v);
+        } else if (q.pop_n(std::back_inserter(batch), 16) == 0) {
+          break;
+        }
+        for (int v : batch) {
+          ++pops[v];
+        }
+        popped += static_cast<long>(batch.size());
+      }
+    });
+  }
+  std::vector<std::thread> writers;
+  for (int t = 0; t < producers; ++t) {
+    writers.emplace_back([&, t] {
+      for (int r = 0; r < rounds; ++r) {
+        for (int i = 0; i < ids; ++i) {
+          if (q.push((i * 31 + t * 7 + r) % ids)) {
+            ++pushed;
+          }
+        }
+      }
+    });
+  }
+  for (auto& w : writers) {
+    w.join();
+  }
+  q.close();
+  for (auto& c : threads) {
+    c.join();
+  }
+  EXPECT_EQ(popped.load(), pushed.load());
+  EXPECT_GE(pushed.load(), static_cast<long>(ids));
+  for (int i = 0; i < ids; ++i) {
+    EXPECT_GE(pops[i].load(), 1);
+  }
+  EXPECT_TRUE(q.empty());
+}
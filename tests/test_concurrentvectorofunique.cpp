@@ -0,0 +1,177 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "concurrentvectorofunique.h"
+
+using namespace containerofunique;
+
+template <class C>
+std::vector<typename C::value_type> contents(const C& c) {
+  return std::vector<typename C::value_type>(c.begin(), c.end());
+}
+
+TEST(ConcurrentVectorOfUniqueTest, DefaultConstructor) {
+  concurrent_vector_of_unique<int> cvou;
+  EXPECT_TRUE(cvou.empty());
+  EXPECT_EQ(cvou.size(), 0u);
+  EXPECT_EQ(cvou.begin(), cvou.end());
+  EXPECT_GE(cvou.shard_count(), 1u);
+}
+
+TEST(ConcurrentVectorOfUniqueTest, ShardCountIsPowerOfTwo) {
+  concurrent_vector_of_unique<int> one(0);
+  EXPECT_EQ(one.shard_count(), 1u);
+  concurrent_vector_of_unique<int> some(5);
+  EXPECT_EQ(some.shard_count(), 8u);
+}
+
+TEST(ConcurrentVectorOfUniqueTest, PushBackRejectsDuplicates) {
+  concurrent_vector_of_unique<std::string> cvou = {"a", "b", "a", "c"};
+  EXPECT_EQ(contents(cvou), std::vector<std::string>({"a", "b", "c"}));
+  EXPECT_FALSE(cvou.push_back("b"));
+  std::string d = "d";
+  EXPECT_TRUE(cvou.push_back(d));
+  EXPECT_TRUE(cvou.emplace_back(3, 'e'));
+  EXPECT_FALSE(cvou.emplace_back("eee"));
+  EXPECT_EQ(cvou.size(), 5u);
+  EXPECT_EQ(cvou[4], "eee");
+  EXPECT_EQ(cvou.index_of("c"), 2u);
+  EXPECT_EQ(cvou.index_of("z"), cvou.npos);
+  EXPECT_EQ(*cvou.find("d"), "d");
+  EXPECT_EQ(cvou.find("z"), cvou.cend());
+#if __cplusplus >= 202002L
+  EXPECT_TRUE(cvou.contains("a"));
+  EXPECT_FALSE(cvou.contains("z"));
+#endif
+}
+
+TEST(ConcurrentVectorOfUniqueTest, Iterators) {
+  concurrent_vector_of_unique<int> cvou = {1, 2, 3, 4};
+  EXPECT_EQ(cvou.end() - cvou.begin(), 4);
+  EXPECT_EQ(cvou.begin()[2], 3);
+  EXPECT_EQ(std::vector<int>(cvou.rbegin(), cvou.rend()),
+            std::vector<int>({4, 3, 2, 1}));
+  auto end = cvou.end();
+  cvou.push_back(5);
+  EXPECT_EQ(std::vector<int>(cvou.begin(), end),
+            std::vector<int>({1, 2, 3, 4}));
+}
+
+TEST(ConcurrentVectorOfUniqueTest, ElementsNeverMove) {
+  concurrent_vector_of_unique<int> cvou(4);
+  cvou.push_back(0);
+  const int* first = &cvou[0];
+  for (int i = 1; i < 100000; ++i) {
+    cvou.push_back(i);
+  }
+  EXPECT_EQ(first, &cvou[0]);
+  for (int i = 0; i < 100000; ++i) {
+    ASSERT_EQ(cvou[i], i);
+  }
+}
+
+TEST(ConcurrentVectorOfUniqueTest, MoveOnlyElements) {
+  struct Hash {
+    size_t operator()(const std::unique_ptr<int>& p) const {
+      return std::hash<int>()(*p);
+    }
+  };
+  struct Equal {
+    bool operator()(const std::unique_ptr<int>& a,
+                    const std::unique_ptr<int>& b) const {
+      return *a == *b;
+    }
+  };
+  concurrent_vector_of_unique<std::unique_ptr<int>, Hash, Equal> cvou;
+  EXPECT_TRUE(cvou.push_back(std::make_unique<int>(1)));
+  EXPECT_FALSE(cvou.push_back(std::make_unique<int>(1)));
+  EXPECT_TRUE(cvou.emplace_back(new int(2)));
+  EXPECT_EQ(cvou.size(), 2u);
+  EXPECT_EQ(*cvou[1], 2);
+}
+
+TEST(ConcurrentVectorOfUniqueTest, ConcurrentPushesKeepOneOfEach) {
+  constexpr int threads = 8;
+  constexpr int values = 20000;
+  concurrent_vector_of_unique<int> cvou;
+  cvou.reserve(values);
+  std::atomic<int> added{0};
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; ++t) {
+    workers.emplace_back([&, t] {
+      // Every thread pushes every value, in a different order.
+      for (int i = 0; i < values; ++i) {
+        int v = (i * 7919 + t * 104729) % values;
+        if (cvou.push_back(v)) {
+          ++added;
+        }
+      }
+    });
+  }
+  for (auto& w : workers) {
+    w.join();
+  }
+  EXPECT_EQ(added.load(), values);
+  ASSERT_EQ(cvou.size(), static_cast<size_t>(values));
+  auto sorted = contents(cvou);
+  std::sort(sorted.begin(), sorted.end());
+  for (int i = 0; i < values; ++i) {
+    ASSERT_EQ(sorted[i], i);
+    ASSERT_EQ(cvou[cvou.index_of(i)], i);
+  }
+}
+
+TEST(ConcurrentVectorOfUniqueTest, ReadersSeeAConsistentPrefix) {
+  constexpr int writers = 4;
+  constexpr int per_writer = 20000;
+  concurrent_vector_of_unique<std::string> cvou(8);
+  std::atomic<bool> done{false};
+  std::atomic<int> bad{0};
+  std::thread reader([&] {
+    std::vector<std::string> seen;
+    while (!done.load()) {
+      size_t i = 0;
+      for (const auto& s : cvou) {
+        // Elements never change once visible, and every visible element is
+        // fully constructed.
+        if (i < seen.size() ? s != seen[i] : s.size() != 12) {
+          ++bad;
+        }
+        if (i >= seen.size()) {
+          seen.push_back(s);
+        }
+        ++i;
+      }
+    }
+    std::set<std::string> unique(seen.begin(), seen.end());
+    if (unique.size() != seen.size()) {
+      ++bad;
+    }
+  });
+  std::vector<std::thread> workers;
+  for (int t = 0; t < writers; ++t) {
+    workers.emplace_back([&, t] {
+      for (int i = 0; i < per_writer; ++i) {
+        auto v = std::to_string(1000000000 + (i % 5000) * writers + t);
+        cvou.push_back(v + (t % 2 == 0 ? "ab" : "cd"));
+        cvou.push_back(v + (t % 2 == 0 ? "cd" : "ab"));
+      }
+    });
+  }
+  for (auto& w : workers) {
+    w.join();
+  }
+  done = true;
+  reader.join();
+  EXPECT_EQ(bad.load(), 0);
+  EXPECT_EQ(cvou.size(), static_cast<size_t>(2 * 5000 * writers));
+}
@@ -3,10 +3,17 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <array>
 #include <compare>
 #include <concepts>
+#include <cstddef>
+#include <cstdint>
 #include <deque>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
 #include <numeric>
+#include <sstream>
 #include <stdexcept>
 #include <string_view>
 #include <unordered_set>
@@ -713,6 +720,29 @@ TEST(DequeOfUniqueTest, InsertAtBeginning) {
   EXPECT_EQ(dou.deque(), (std::deque<std::string>{"hello", "world"}));
 }
 
+TEST(DequeOfUniqueTest, InsertAndEraseAtFront_KeepPositions) {
+  deque_of_unique<int> dou = {10, 11, 12};
+  for (int i = 9; i >= 0; --i) {
+    auto result = dou.insert(dou.cbegin(), i);
+    EXPECT_TRUE(result.second);
+    EXPECT_EQ(result.first, dou.cbegin());
+  }
+  EXPECT_FALSE(dou.insert(dou.cbegin(), 12).second);
+  for (int i = 0; i < 13; ++i) {
+    EXPECT_EQ(dou.index_of(i), static_cast<size_t>(i));
+  }
+  for (int i = 0; i < 5; ++i) {
+    auto it = dou.erase(dou.cbegin());
+    EXPECT_EQ(it, dou.cbegin());
+    EXPECT_EQ(*it, i + 1);
+  }
+  dou.insert(dou.cbegin() + 2, 100);
+  EXPECT_EQ(dou.index_of(0), deque_of_unique<int>::npos);
+  EXPECT_EQ(dou.index_of(5), 0u);
+  EXPECT_EQ(dou.index_of(100), 2u);
+  EXPECT_EQ(dou.index_of(12), 8u);
+}
+
 TEST(DequeOfUniqueTest, InsertDuplicateElement) {
   deque_of_unique<std::string> dou = {"hello", "world"};
   auto result = dou.insert(dou.cend(), "hello");
@@ -1950,3 +1980,819 @@ TEST(DequeOfUniqueTest, PrependRange_EmptyRange) {
   EXPECT_EQ(dou.deque(), std::deque<int>({1, 2}));
 }
 #endif
+
+// Tests for position tracking
+TEST(DequeOfUniqueTest, IndexOf_TracksBothEnds) {
+  deque_of_unique<int> dou = {3, 4};
+  dou.push_front(2);
+  dou.push_front(1);
+  dou.push_back(5);
+  for (size_t i = 0; i < dou.size(); ++i) {
+    EXPECT_EQ(dou.index_of(dou[i]), i);
+  }
+  dou.pop_front();
+  EXPECT_EQ(dou.index_of(1), deque_of_unique<int>::npos);
+  EXPECT_EQ(dou.index_of(2), 0u);
+  EXPECT_EQ(dou.index_of(5), 3u);
+  dou.pop_back();
+  EXPECT_EQ(dou.index_of(5), deque_of_unique<int>::npos);
+  EXPECT_EQ(dou.index_of(4), 2u);
+}
+
+TEST(DequeOfUniqueTest, IndexOf_TracksMiddleInsertAndErase) {
+  deque_of_unique<std::string> dou = {"a", "b", "c", "d", "e", "f"};
+  dou.erase(dou.cbegin() + 2);
+  dou.insert(dou.cbegin() + 1, "x");
+  dou.erase(dou.cbegin(), dou.cbegin() + 2);
+  dou.push_front("y");
+  dou.erase(dou.cbegin() + 2, dou.cbegin() + 3);
+  ASSERT_EQ(dou.deque(), (std::deque<std::string>{"y", "b", "e", "f"}));
+  for (size_t i = 0; i < dou.size(); ++i) {
+    EXPECT_EQ(dou.index_of(dou[i]), i);
+    EXPECT_EQ(dou.find(dou[i]), dou.cbegin() + static_cast<std::ptrdiff_t>(i));
+  }
+  EXPECT_EQ(dou.index_of("a"), deque_of_unique<std::string>::npos);
+  EXPECT_EQ(dou.index_of("d"), deque_of_unique<std::string>::npos);
+  EXPECT_EQ(dou.index_of("x"), deque_of_unique<std::string>::npos);
+}
+
+TEST(DequeOfUniqueTest, IndexOf_AfterClear) {
+  deque_of_unique<int> dou = {1, 2, 3};
+  dou.push_front(0);
+  dou.clear();
+  EXPECT_EQ(dou.index_of(0), deque_of_unique<int>::npos);
+  dou.push_back(7);
+  dou.push_front(6);
+  EXPECT_EQ(dou.index_of(6), 0u);
+  EXPECT_EQ(dou.index_of(7), 1u);
+}
+
+#if __cplusplus >= 202002L
+TEST(DequeOfUniqueTest, IndexOf_HeterogeneousLookup) {
+  deque_of_unique<std::string, StringHash, StringEqual> dou = {"hello",
+                                                               "world"};
+  EXPECT_EQ(dou.index_of(std::string_view("world")), 1u);
+  EXPECT_EQ(dou.index_of(std::string_view("foo")),
+            (deque_of_unique<std::string, StringHash, StringEqual>::npos));
+}
+#endif
+
+TEST(DequeOfUniqueTest, EraseIf_CallsPredicateOncePerElement) {
+  deque_of_unique<int> dou = {1, 2, 3, 4, 5, 6, 7, 8};
+  int calls = 0;
+  auto removed = erase_if(dou, [&calls](int x) {
+    ++calls;
+    return x % 3 != 0;
+  });
+  EXPECT_EQ(removed, 6u);
+  EXPECT_EQ(calls, 8);
+  EXPECT_EQ(dou.deque(), std::deque<int>({3, 6}));
+}
+
+TEST(DequeOfUniqueTest, EraseIf_KeepsIndexConsistent) {
+  deque_of_unique<int> dou;
+  for (int i = 0; i < 500; ++i) {
+    dou.push_back(i);
+    dou.push_front(-i - 1);
+  }
+  auto removed = erase_if(dou, [](int x) { return x % 10 == 0; });
+  EXPECT_EQ(removed, 100u);
+  ASSERT_EQ(dou.size(), 900u);
+  EXPECT_EQ(dou.set().size(), 900u);
+  for (size_t i = 0; i < dou.size(); ++i) {
+    EXPECT_EQ(dou.index_of(dou[i]), i);
+  }
+  EXPECT_EQ(dou.find(-10), dou.cend());
+  EXPECT_TRUE(dou.push_front(-10));
+  EXPECT_EQ(dou.index_of(-10), 0u);
+}
+
+TEST(DequeOfUniqueTest, EraseIf_ThrowingPredicateLeavesContainerIntact) {
+  deque_of_unique<std::string> dou;
+  for (int i = 0; i < 10; ++i) {
+    dou.push_back(std::to_string(i));
+  }
+  int calls = 0;
+  EXPECT_THROW(erase_if(dou,
+                        [&](const std::string& s) {
+                          if (++calls == 6) {
+                            throw std::runtime_error("predicate");
+                          }
+                          return s == "1" || s == "3";
+                        }),
+               std::runtime_error);
+  ASSERT_EQ(dou.size(), 10u);
+  for (size_t i = 0; i < dou.size(); ++i) {
+    EXPECT_EQ(dou[i], std::to_string(i));
+    EXPECT_EQ(dou.index_of(dou[i]), i);
+  }
+  EXPECT_FALSE(dou.push_back("5"));
+  EXPECT_EQ(erase_if(dou, [](const std::string& s) { return s == "1"; }), 1u);
+  EXPECT_EQ(dou.index_of("9"), 8u);
+}
+
+TEST(DequeOfUniqueTest, Reserve_SizesIndex) {
+  deque_of_unique<int> dou;
+  dou.reserve(1000);
+  EXPECT_GE(static_cast<float>(dou.bucket_count()) * dou.max_load_factor(),
+            1000.0f);
+  auto buckets = dou.bucket_count();
+  for (int i = 0; i < 1000; ++i) {
+    dou.push_front(i);
+  }
+  EXPECT_EQ(dou.bucket_count(), buckets);
+}
+
+TEST(DequeOfUniqueTest, ShrinkToFit) {
+  deque_of_unique<int> dou;
+  for (int i = 0; i < 1000; ++i) {
+    dou.push_back(i);
+  }
+  auto buckets = dou.bucket_count();
+  dou.erase(dou.cbegin(), dou.cend() - 10);
+  dou.shrink_to_fit();
+  EXPECT_LT(dou.bucket_count(), buckets);
+  EXPECT_EQ(dou.index_of(990), 0u);
+  EXPECT_EQ(dou.find(989), dou.cend());
+}
+
+TEST(DequeOfUniqueTest, HashPolicy) {
+  deque_of_unique<int> dou = {1, 2, 3, 4};
+  EXPECT_FLOAT_EQ(dou.max_load_factor(), 1.0f);
+  dou.max_load_factor(0.5f);
+  EXPECT_FLOAT_EQ(dou.max_load_factor(), 0.5f);
+  EXPECT_LE(dou.load_factor(), 0.5f);
+  dou.rehash(256);
+  EXPECT_GE(dou.bucket_count(), 256u);
+  EXPECT_EQ(dou.index_of(3), 2u);
+}
+
+#if __cplusplus >= 201703L
+// memory_resource that counts the bytes allocated through it.
+class CountingResource : public std::pmr::memory_resource {
+ public:
+  size_t allocated = 0;
+
+ private:
+  void* do_allocate(size_t bytes, size_t alignment) override {
+    allocated += bytes;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+  void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+  }
+  bool do_is_equal(
+      const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+};
+
+TEST(DequeOfUniqueTest, Pmr_AllocatesFromResource) {
+  CountingResource resource;
+  pmr::deque_of_unique<std::pmr::string> dou(&resource);
+  EXPECT_EQ(dou.get_allocator().resource(), &resource);
+  dou.push_back("a string long enough to defeat the small string buffer");
+  dou.push_back("b");
+  dou.push_back("b");
+  EXPECT_EQ(dou.size(), 2u);
+  EXPECT_GT(resource.allocated, 0u);
+  EXPECT_EQ(dou[0].get_allocator().resource(), &resource);
+}
+
+TEST(DequeOfUniqueTest, Pmr_MonotonicBuffer) {
+  std::array<std::byte, 4096> buffer{};
+  std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size(),
+                                            std::pmr::null_memory_resource());
+  pmr::deque_of_unique<int> dou({1, 2, 3, 2, 1}, &arena);
+  EXPECT_EQ(dou.size(), 3u);
+  EXPECT_EQ(dou.index_of(3), 2u);
+  EXPECT_EQ(erase(dou, 2), 1u);
+  EXPECT_EQ(dou.index_of(3), 1u);
+}
+
+TEST(DequeOfUniqueTest, Pmr_AllocatorExtendedCopyAndMove) {
+  CountingResource first;
+  CountingResource second;
+  pmr::deque_of_unique<int> dou1({1, 2, 3}, &first);
+
+  pmr::deque_of_unique<int> copy(dou1, &second);
+  EXPECT_EQ(copy.get_allocator().resource(), &second);
+  EXPECT_EQ(copy, dou1);
+
+  // A plain copy does not propagate a polymorphic allocator.
+  // NOLINTNEXTLINE(performance-unnecessary-copy-initialization)
+  pmr::deque_of_unique<int> plain_copy(dou1);
+  EXPECT_EQ(plain_copy.get_allocator().resource(),
+            std::pmr::get_default_resource());
+
+  pmr::deque_of_unique<int> moved(std::move(dou1), &second);
+  EXPECT_EQ(moved.get_allocator().resource(), &second);
+  EXPECT_EQ(moved.index_of(3), 2u);
+  // NOLINTNEXTLINE(bugprone-use-after-move,clang-analyzer-cplusplus.Move)
+  EXPECT_TRUE(dou1.empty());
+  EXPECT_TRUE(moved.push_back(4));
+  EXPECT_FALSE(moved.push_back(1));
+}
+#endif
+
+// Hasher that counts how often it is invoked.
+struct CountingHash {
+  static int calls;
+  size_t operator()(int x) const {
+    ++calls;
+    return std::hash<int>{}(x);
+  }
+};
+int CountingHash::calls = 0;
+
+TEST(DequeOfUniqueTest, CopyConstructor_DoesNotRehash) {
+  deque_of_unique<int, CountingHash> dou1 = {1, 2, 3, 4, 5};
+  CountingHash::calls = 0;
+  // NOLINTNEXTLINE(performance-unnecessary-copy-initialization)
+  deque_of_unique<int, CountingHash> dou2(dou1);
+  EXPECT_EQ(CountingHash::calls, 0);
+  EXPECT_EQ(dou2.deque(), std::deque<int>({1, 2, 3, 4, 5}));
+  EXPECT_EQ(dou2.set().size(), 5u);
+  EXPECT_EQ(dou2.index_of(4), 3u);
+  EXPECT_FALSE(dou2.push_back(5));
+  EXPECT_TRUE(dou2.push_back(6));
+  EXPECT_EQ(dou1.size(), 5u);
+}
+
+TEST(DequeOfUniqueTest, CopyAssignment_DoesNotRehash) {
+  deque_of_unique<int, CountingHash> dou1 = {1, 2, 3};
+  deque_of_unique<int, CountingHash> dou2 = {7, 8};
+  CountingHash::calls = 0;
+  dou2 = dou1;
+  EXPECT_EQ(CountingHash::calls, 0);
+  EXPECT_EQ(dou2, dou1);
+  EXPECT_EQ(dou2.index_of(3), 2u);
+  EXPECT_EQ(dou2.find(7), dou2.cend());
+}
+
+TEST(DequeOfUniqueTest, CopyConstructor_KeepsFrontPositions) {
+  deque_of_unique<int> dou1 = {3, 4};
+  dou1.push_front(2);
+  dou1.push_front(1);
+  // NOLINTNEXTLINE(performance-unnecessary-copy-initialization)
+  deque_of_unique<int> dou2(dou1);
+  for (size_t i = 0; i < dou2.size(); ++i) {
+    EXPECT_EQ(dou2.index_of(dou2[i]), i);
+  }
+  dou2.pop_front();
+  EXPECT_EQ(dou2.index_of(2), 0u);
+  EXPECT_TRUE(dou2.push_front(0));
+  EXPECT_EQ(dou2.index_of(4), 3u);
+}
+
+// Tests for move-only and zero-copy insertion
+struct MoveCounted {
+  static int copies;
+  static int moves;
+  int value;
+
+  explicit MoveCounted(int v) : value(v) {}
+  MoveCounted(const MoveCounted& other) : value(other.value) { ++copies; }
+  MoveCounted(MoveCounted&& other) noexcept : value(other.value) { ++moves; }
+  MoveCounted& operator=(const MoveCounted& other) = delete;
+  MoveCounted& operator=(MoveCounted&& other) noexcept {
+    value = other.value;
+    ++moves;
+    return *this;
+  }
+  ~MoveCounted() = default;
+
+  bool operator==(const MoveCounted& other) const {
+    return value == other.value;
+  }
+};
+int MoveCounted::copies = 0;
+int MoveCounted::moves = 0;
+
+struct MoveCountedHash {
+  size_t operator()(const MoveCounted& m) const {
+    return std::hash<int>{}(m.value);
+  }
+};
+
+TEST(DequeOfUniqueTest, PushFrontAndBack_RvalueMakesNoCopy) {
+  deque_of_unique<MoveCounted, MoveCountedHash> dou;
+  MoveCounted::copies = 0;
+  EXPECT_TRUE(dou.push_back(MoveCounted(1)));
+  EXPECT_TRUE(dou.push_front(MoveCounted(0)));
+  EXPECT_FALSE(dou.push_front(MoveCounted(1)));
+  EXPECT_FALSE(dou.push_back(MoveCounted(0)));
+  EXPECT_TRUE(dou.insert(dou.cbegin() + 1, MoveCounted(5)).second);
+  EXPECT_EQ(MoveCounted::copies, 0);
+  EXPECT_EQ(dou.index_of(MoveCounted(1)), 2u);
+}
+
+TEST(DequeOfUniqueTest, InsertRange_MovesShorterSideOnce) {
+  for (size_t pos : {100u, 900u}) {
+    deque_of_unique<MoveCounted, MoveCountedHash> dou;
+    for (int i = 500; i < 1000; ++i) {
+      dou.push_back(MoveCounted(i));
+    }
+    for (int i = 499; i >= 0; --i) {
+      dou.push_front(MoveCounted(i));
+    }
+    std::vector<MoveCounted> input;
+    for (int i = 0; i < 200; ++i) {
+      // Every other element is already present.
+      input.emplace_back(i % 2 == 0 ? 1000 + i : i);
+    }
+    MoveCounted::copies = 0;
+    MoveCounted::moves = 0;
+    auto it = dou.insert(dou.cbegin() + pos, input.begin(), input.end());
+    EXPECT_EQ(it, dou.cbegin() + pos);
+    EXPECT_EQ(MoveCounted::copies, 100);
+    // Only the 100 elements between pos and the nearer end move, besides
+    // the inserted ones; one at a time, they would move 100 times each.
+    EXPECT_LT(MoveCounted::moves, 1000);
+    ASSERT_EQ(dou.size(), 1100u);
+    for (size_t i = 0; i < 1100; ++i) {
+      auto expected = static_cast<int>(
+          i < pos ? i : i < pos + 100 ? 1000 + 2 * (i - pos) : i - 100);
+      EXPECT_EQ(dou[i].value, expected);
+      EXPECT_EQ(dou.index_of(MoveCounted(expected)), i);
+    }
+  }
+}
+
+TEST(DequeOfUniqueTest, InsertRange_SmallBatchesGrowGeometrically) {
+  deque_of_unique<int> dou;
+  for (int i = 0; i < 1000; ++i) {
+    dou.push_back(i);
+  }
+  int rehashes = 0;
+  for (int i = 1000; i < 9000; i += 2) {
+    auto buckets = dou.bucket_count();
+    const int batch[] = {i, i + 1, i};
+    dou.insert(dou.cbegin() + 10, std::begin(batch), std::end(batch));
+    rehashes += dou.bucket_count() != buckets ? 1 : 0;
+  }
+  ASSERT_EQ(dou.size(), 9000u);
+  EXPECT_LE(rehashes, 8);
+  EXPECT_EQ(dou.index_of(8999), 11u);
+  EXPECT_EQ(dou.index_of(999), 8999u);
+}
+
+TEST(DequeOfUniqueTest, EmplaceFrontAndBack_MoveOnlyUniqueElements) {
+  deque_of_unique<MoveCounted, MoveCountedHash> dou;
+  MoveCounted::copies = 0;
+  MoveCounted::moves = 0;
+  dou.emplace_back(2);
+  dou.emplace_front(1);
+  EXPECT_EQ(MoveCounted::moves, 2);
+  MoveCounted::moves = 0;
+  dou.emplace_front(2);
+  dou.emplace_back(1);
+  EXPECT_EQ(MoveCounted::moves, 0);
+  dou.emplace_back(3);
+  EXPECT_EQ(MoveCounted::copies, 0);
+  EXPECT_EQ(MoveCounted::moves, 1);
+  ASSERT_EQ(dou.size(), 3u);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(dou.index_of(MoveCounted(i + 1)), static_cast<size_t>(i));
+  }
+}
+
+TEST(DequeOfUniqueTest, Emplace_MovesOnlyUniqueElements) {
+  deque_of_unique<MoveCounted, MoveCountedHash> dou;
+  MoveCounted::copies = 0;
+  MoveCounted::moves = 0;
+  EXPECT_TRUE(dou.emplace(dou.cend(), 2).second);
+  auto result = dou.emplace(dou.cbegin(), 1);
+  EXPECT_TRUE(result.second);
+  EXPECT_EQ(result.first, dou.cbegin());
+  result = dou.emplace(dou.cend(), 3);
+  EXPECT_TRUE(result.second);
+  EXPECT_EQ(result.first->value, 3);
+  EXPECT_EQ(MoveCounted::moves, 3);
+  MoveCounted::moves = 0;
+  EXPECT_FALSE(dou.emplace(dou.cbegin(), 3).second);
+  EXPECT_FALSE(dou.emplace(dou.cend(), 1).second);
+  EXPECT_FALSE(dou.emplace(dou.cbegin() + 1, 2).second);
+  EXPECT_EQ(MoveCounted::copies, 0);
+  EXPECT_EQ(MoveCounted::moves, 0);
+  result = dou.emplace(dou.cbegin() + 1, 0);
+  EXPECT_TRUE(result.second);
+  EXPECT_EQ(result.first, dou.cbegin() + 1);
+  EXPECT_EQ(MoveCounted::copies, 0);
+  ASSERT_EQ(dou.size(), 4u);
+  const std::array<int, 4> expected = {1, 0, 2, 3};
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(dou.index_of(MoveCounted(expected[i])), i);
+  }
+}
+
+TEST(DequeOfUniqueTest, Emplace_DuplicateKeepsIterators) {
+  deque_of_unique<int> dou = {1, 2, 3};
+  auto first = dou.cbegin();
+  auto last = dou.cend() - 1;
+#if __cplusplus >= 201703L
+  EXPECT_FALSE(dou.emplace_front(2).has_value());
+  EXPECT_FALSE(dou.emplace_back(1).has_value());
+#else
+  dou.emplace_front(2);
+  dou.emplace_back(1);
+#endif
+  EXPECT_FALSE(dou.emplace(dou.cbegin(), 3).second);
+  EXPECT_FALSE(dou.emplace(dou.cend(), 2).second);
+  // A rejected duplicate never reaches the std::deque, so iterators stay
+  // valid.
+  EXPECT_EQ(first, dou.cbegin());
+  EXPECT_EQ(*first, 1);
+  EXPECT_EQ(*last, 3);
+  EXPECT_EQ(dou.deque(), std::deque<int>({1, 2, 3}));
+}
+
+struct ThrowingIntHash {
+  size_t operator()(int v) const {
+    if (v == 13) {
+      throw std::runtime_error("unlucky");
+    }
+    return std::hash<int>{}(v);
+  }
+};
+
+TEST(DequeOfUniqueTest, Emplace_ThrowingHashLeavesNoElement) {
+  deque_of_unique<int, ThrowingIntHash> dou = {1, 2};
+  EXPECT_THROW(dou.emplace_front(13), std::runtime_error);
+  EXPECT_THROW(dou.emplace_back(13), std::runtime_error);
+  EXPECT_THROW(dou.emplace(dou.cbegin(), 13), std::runtime_error);
+  EXPECT_EQ(dou.deque(), std::deque<int>({1, 2}));
+#if __cplusplus >= 201703L
+  EXPECT_TRUE(dou.emplace_front(0).has_value());
+  EXPECT_TRUE(dou.emplace_back(3).has_value());
+#else
+  dou.emplace_front(0);
+  dou.emplace_back(3);
+#endif
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(dou.index_of(i), static_cast<size_t>(i));
+  }
+}
+
+TEST(DequeOfUniqueTest, MoveOnly_Modifiers) {
+  deque_of_unique<std::unique_ptr<int>> dou;
+  auto one = std::make_unique<int>(1);
+  const int* one_raw = one.get();
+  EXPECT_TRUE(dou.push_back(std::move(one)));
+  EXPECT_TRUE(dou.push_front(std::make_unique<int>(0)));
+  EXPECT_TRUE(dou.insert(dou.cbegin() + 1, std::make_unique<int>(5)).second);
+  ASSERT_EQ(dou.size(), 3u);
+  EXPECT_EQ(dou.back().get(), one_raw);
+  dou.pop_front();
+  EXPECT_EQ(
+      erase_if(dou, [](const std::unique_ptr<int>& p) { return *p == 5; }), 1u);
+  ASSERT_EQ(dou.size(), 1u);
+  EXPECT_EQ(*dou.front(), 1);
+}
+
+TEST(DequeOfUniqueTest, AppendBulk_SkipsDuplicates) {
+  deque_of_unique<int> dou = {1, 2};
+  std::vector<int> input(200);
+  std::iota(input.begin(), input.end(), 0);
+  input.insert(input.end(), input.begin(), input.begin() + 50);
+  EXPECT_EQ(dou.append_bulk(input.begin(), input.end()), 198u);
+  ASSERT_EQ(dou.size(), 200u);
+  EXPECT_EQ(dou[0], 1);
+  EXPECT_EQ(dou[1], 2);
+  EXPECT_EQ(dou[2], 0);
+  for (int i = 3; i < 200; ++i) {
+    EXPECT_EQ(dou.index_of(i), static_cast<size_t>(i));
+  }
+  EXPECT_EQ(dou.append_bulk(input.begin(), input.end()), 0u);
+}
+
+TEST(DequeOfUniqueTest, AppendBulk_InputIterator) {
+  deque_of_unique<int> dou = {3};
+  std::istringstream in("1 2 3 2 4");
+  EXPECT_EQ(dou.append_bulk(std::istream_iterator<int>(in),
+                            std::istream_iterator<int>()),
+            3u);
+  EXPECT_EQ(dou.deque(), std::deque<int>({3, 1, 2, 4}));
+}
+
+TEST(DequeOfUniqueTest, AppendBulk_MovesFromMoveIterators) {
+  deque_of_unique<std::string> dou;
+  std::vector<std::string> input = {"a", "b", "a"};
+  EXPECT_EQ(dou.append_bulk(std::make_move_iterator(input.begin()),
+                            std::make_move_iterator(input.end())),
+            2u);
+  EXPECT_EQ(dou.index_of("b"), 1u);
+  EXPECT_TRUE(input[1].empty());
+  EXPECT_EQ(input[2], "a");
+}
+
+TEST(DequeOfUniqueTest, InsertBulk_RotatesIntoPlace) {
+  deque_of_unique<int> dou = {2, 3};
+  dou.push_front(1);
+  std::vector<int> input = {7, 2, 8, 7, 9};
+  EXPECT_EQ(dou.insert_bulk(dou.cbegin() + 1, input.begin(), input.end()),
+            3u);
+  ASSERT_EQ(dou.size(), 6u);
+  const std::array<int, 6> expected = {1, 7, 8, 9, 2, 3};
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(dou[i], expected[i]);
+    EXPECT_EQ(dou.index_of(expected[i]), i);
+  }
+  EXPECT_EQ(dou.insert_bulk(dou.cend(), input.begin(), input.end()), 0u);
+}
+
+TEST(DequeOfUniqueTest, SetOperations_KeepOrder) {
+  const deque_of_unique<int> small = {9, 4, 6};
+  const deque_of_unique<int> large = {6, 7, 8, 9, 10, 11};
+  for (const auto* other : {&small, &large}) {
+    // Built from both ends so slots do not start at zero.
+    deque_of_unique<int> dou = {3, 6, 7};
+    dou.push_front(9);
+    dou.push_front(4);
+    dou.push_front(1);
+    auto inter = dou;
+    auto diff = dou;
+    dou.merge_from(*other);
+    inter.intersect_with(*other);
+    diff.subtract(*other);
+    for (const auto* d : {&dou, &inter, &diff}) {
+      for (size_t i = 0; i < d->size(); ++i) {
+        EXPECT_EQ(d->index_of((*d)[i]), i);
+      }
+    }
+    if (other == &small) {
+      EXPECT_EQ(dou, deque_of_unique<int>({1, 4, 9, 3, 6, 7}));
+      EXPECT_EQ(inter, deque_of_unique<int>({4, 9, 6}));
+      EXPECT_EQ(diff, deque_of_unique<int>({1, 3, 7}));
+    } else {
+      EXPECT_EQ(dou, deque_of_unique<int>({1, 4, 9, 3, 6, 7, 8, 10, 11}));
+      EXPECT_EQ(inter, deque_of_unique<int>({9, 6, 7}));
+      EXPECT_EQ(diff, deque_of_unique<int>({1, 4, 3}));
+    }
+  }
+
+  deque_of_unique<int> dou = {1, 2};
+  EXPECT_EQ(dou.merge_from(dou), 0u);
+  EXPECT_EQ(dou.intersect_with(dou), 0u);
+  EXPECT_EQ(dou.subtract(dou), 2u);
+  EXPECT_TRUE(dou.empty());
+}
+
+using FlatInt =
+    deque_of_unique<int, std::hash<int>, std::equal_to<int>, std::allocator<int>,
+                     flat_index>;
+
+TEST(DequeOfUniqueTest, FlatIndex_Modifiers) {
+  FlatInt dou;
+  for (int i = 0; i < 10000; ++i) {
+    EXPECT_TRUE(dou.push_back(i));
+    EXPECT_FALSE(dou.push_back(i / 2));
+  }
+  dou.push_front(-1);
+  EXPECT_EQ(dou.index_of(-1), 0u);
+  dou.pop_front();
+  EXPECT_EQ(erase_if(dou, [](int x) { return x % 2 == 0; }), 5000u);
+  EXPECT_TRUE(dou.insert(dou.cbegin() + 1, 0).second);
+  dou.erase(dou.cbegin() + 2);
+  dou.pop_back();
+  ASSERT_EQ(dou.size(), 4999u);
+  EXPECT_EQ(dou.index_of(0), 1u);
+  for (size_t i = 2; i < dou.size(); ++i) {
+    EXPECT_EQ(dou.index_of(dou[i]), i);
+  }
+  EXPECT_EQ(dou.find(3), dou.cend());
+  EXPECT_EQ(dou.find(9999), dou.cend());
+
+  FlatInt copy(dou);
+  EXPECT_EQ(copy, dou);
+  EXPECT_EQ(copy.index_of(5), 2u);
+  FlatInt moved(std::move(copy));
+  EXPECT_EQ(moved.index_of(5), 2u);
+  copy = moved;
+  EXPECT_EQ(copy.index_of(7), 3u);
+  dou.clear();
+  EXPECT_EQ(dou.find(5), dou.cend());
+  EXPECT_TRUE(dou.push_back(5));
+  EXPECT_EQ(dou.index_of(5), 0u);
+}
+
+struct ModFourHash {
+  size_t operator()(int x) const { return static_cast<size_t>(x % 4); }
+};
+
+TEST(DequeOfUniqueTest, FlatIndex_CollidingHashes) {
+  deque_of_unique<int, ModFourHash, std::equal_to<int>, std::allocator<int>,
+                   flat_index>
+      dou;
+  for (int i = 0; i < 500; ++i) {
+    dou.push_back(i);
+  }
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 0; i < 500; i += 3) {
+      erase(dou, i);
+      EXPECT_TRUE(dou.push_back(i));
+    }
+  }
+  ASSERT_EQ(dou.size(), 500u);
+  for (size_t i = 0; i < dou.size(); ++i) {
+    EXPECT_EQ(dou.index_of(dou[i]), i);
+  }
+  EXPECT_EQ(dou.find(500), dou.cend());
+}
+
+TEST(DequeOfUniqueTest, FlatIndex_CapacityAndHashPolicy) {
+  FlatInt dou;
+  EXPECT_EQ(dou.bucket_count(), 0u);
+  EXPECT_LE(dou.max_load_factor(), 0.875f);
+  dou.reserve(1000);
+  auto buckets = dou.bucket_count();
+  EXPECT_GE(static_cast<float>(buckets) * dou.max_load_factor(), 1000.0f);
+  for (int i = 0; i < 1000; ++i) {
+    dou.push_back(i);
+  }
+  EXPECT_EQ(dou.bucket_count(), buckets);
+  EXPECT_LE(dou.load_factor(), dou.max_load_factor());
+  dou.max_load_factor(0.5f);
+  EXPECT_FLOAT_EQ(dou.max_load_factor(), 0.5f);
+  EXPECT_LE(dou.load_factor(), 0.5f);
+  erase_if(dou, [](int x) { return x >= 10; });
+  dou.shrink_to_fit();
+  EXPECT_LT(dou.bucket_count(), buckets);
+  EXPECT_EQ(dou.index_of(9), 9u);
+}
+
+TEST(DequeOfUniqueTest, FlatIndex_SlidingWindowKeepsTableSize) {
+  FlatInt dou;
+  for (int i = 0; i < 1000; ++i) {
+    dou.push_back(i);
+  }
+  auto buckets = dou.bucket_count();
+  for (int i = 1000; i < 50000; ++i) {
+    dou.pop_front();
+    EXPECT_TRUE(dou.push_back(i));
+    EXPECT_FALSE(dou.push_back(i - 500));
+  }
+  EXPECT_EQ(dou.bucket_count(), buckets);
+  ASSERT_EQ(dou.size(), 1000u);
+  for (size_t i = 0; i < dou.size(); ++i) {
+    EXPECT_EQ(dou.index_of(dou[i]), i);
+  }
+  EXPECT_EQ(dou.find(48999), dou.cend());
+}
+
+template <class IndexPolicy>
+using CachedInt =
+    deque_of_unique<int, CountingHash, std::equal_to<int>, std::allocator<int>,
+                    cached_hash<IndexPolicy>>;
+
+TEST(DequeOfUniqueTest, CachedHash_ErasureDoesNotRehash) {
+  CachedInt<node_index> dou = {1, 2, 3, 4, 5, 6, 7, 8};
+  dou.push_front(0);
+  CountingHash::calls = 0;
+  dou.pop_front();
+  dou.pop_back();
+  dou.erase(dou.cbegin() + 1);
+  dou.erase(dou.cbegin(), dou.cbegin() + 1);
+  dou.erase(dou.cend() - 2, dou.cend());
+  EXPECT_EQ(CountingHash::calls, 0);
+  EXPECT_EQ(dou.deque(), std::deque<int>({3, 4, 5}));
+  for (size_t i = 0; i < dou.size(); ++i) {
+    EXPECT_EQ(dou.index_of(dou[i]), i);
+  }
+  EXPECT_FALSE(dou.push_front(4));
+  EXPECT_TRUE(dou.push_front(1));
+}
+
+TEST(DequeOfUniqueTest, CachedHash_SlidingWindow) {
+  CachedInt<flat_index> dou;
+  CountingHash::calls = 0;
+  for (int i = 0; i < 10000; ++i) {
+    EXPECT_TRUE(dou.insert_with_hash(i, std::hash<int>{}(i)));
+    if (dou.size() > 100) {
+      dou.pop_front();
+    }
+  }
+  EXPECT_FALSE(dou.insert_with_hash(9999, std::hash<int>{}(9999)));
+  EXPECT_EQ(CountingHash::calls, 0);
+  EXPECT_EQ(dou.front(), 9900);
+  EXPECT_EQ(dou.index_of(9950), 50u);
+  EXPECT_EQ(dou.find(9899), dou.cend());
+}
+
+TEST(DequeOfUniqueTest, ExtractAndInsertNodes) {
+  deque_of_unique<std::string> src = {"b", "c", "d"};
+  src.push_front("a");
+  deque_of_unique<std::string> dst = {"c"};
+  auto nh = src.extract(src.cbegin() + 2);
+  ASSERT_FALSE(nh.empty());
+  EXPECT_EQ(nh.value(), "c");
+  EXPECT_EQ(src, deque_of_unique<std::string>({"a", "b", "d"}));
+  EXPECT_EQ(src.index_of("d"), 2u);
+
+  // A duplicate is handed back in the result.
+  auto dup = dst.insert(std::move(nh));
+  EXPECT_FALSE(dup.inserted);
+  EXPECT_EQ(*dup.position, "c");
+  ASSERT_FALSE(dup.node.empty());
+
+  auto result = dst.insert(src.extract("a"));
+  EXPECT_TRUE(result.inserted);
+  EXPECT_EQ(*result.position, "a");
+  EXPECT_EQ(dst, deque_of_unique<std::string>({"c", "a"}));
+  EXPECT_EQ(src, deque_of_unique<std::string>({"b", "d"}));
+  EXPECT_TRUE(src.push_front("x"));
+  EXPECT_EQ(src.index_of("d"), 2u);
+  EXPECT_TRUE(src.insert(std::move(dup.node)).inserted);
+  EXPECT_EQ(src.index_of("c"), 3u);
+  EXPECT_TRUE(src.extract("z").empty());
+}
+
+TEST(DequeOfUniqueTest, CachedHash_MoveNodesWithoutHashing) {
+  // The node_index entries themselves move too, since C++17.
+  CachedInt<node_index> src = {1, 2, 3, 4, 5, 6};
+  CachedInt<node_index> dst;
+  CountingHash::calls = 0;
+  for (auto pos : {0, 4, 1, 0}) {
+    EXPECT_TRUE(dst.insert(src.extract(src.cbegin() + pos)).inserted);
+  }
+  EXPECT_EQ(CountingHash::calls, 0);
+  EXPECT_EQ(src.size(), 2u);
+  EXPECT_EQ(dst.size(), 4u);
+  for (const auto* d : {&src, &dst}) {
+    for (size_t i = 0; i < d->size(); ++i) {
+      EXPECT_EQ(d->index_of((*d)[i]), i);
+    }
+  }
+  EXPECT_EQ(dst.front(), 1);
+  EXPECT_EQ(dst.back(), 2);
+  while (!dst.empty()) {
+    src.insert(dst.extract(dst.cend() - 1));
+  }
+  EXPECT_EQ(src.size(), 6u);
+  EXPECT_EQ(src.index_of(1), 5u);
+}
+
+TEST(DequeOfUniqueTest, AdoptAndReleaseWithoutCopying) {
+  std::deque<std::string> input = {"c", "a", "b"};
+  const auto* first = &input.front();
+  auto dou = deque_of_unique<std::string>::adopt_unique(std::move(input));
+  EXPECT_EQ(&dou.front(), first);
+  EXPECT_EQ(dou.index_of("b"), 2u);
+  EXPECT_FALSE(dou.push_front("a"));
+  EXPECT_TRUE(dou.push_front("d"));
+  EXPECT_EQ(dou.index_of("b"), 3u);
+
+  auto released = std::move(dou).release();
+  EXPECT_EQ(released, std::deque<std::string>({"d", "c", "a", "b"}));
+  EXPECT_EQ(&released[1], first);
+  EXPECT_TRUE(dou.empty());
+  EXPECT_TRUE(dou.push_front("a"));
+  EXPECT_EQ(dou.index_of("a"), 0u);
+}
+
+TEST(DequeOfUniqueTest, BloomFilter_SlidingWindow) {
+  deque_of_unique<int, std::hash<int>, std::equal_to<int>, std::allocator<int>,
+                  bloom_filter<>>
+      dou;
+  for (int i = 0; i < 20000; ++i) {
+    EXPECT_TRUE(dou.push_back(i));
+    if (dou.size() > 100) {
+      dou.pop_front();
+    }
+  }
+  // Rebuilds drop the bits of keys that left the window, so old keys are
+  // still filtered.
+  auto before = dou.prefilter_stats();
+  for (int i = 0; i < 19000; ++i) {
+    EXPECT_EQ(dou.find(i), dou.cend());
+  }
+  auto after = dou.prefilter_stats();
+  EXPECT_EQ(after.lookups - before.lookups, 19000u);
+  EXPECT_GT(after.filtered - before.filtered, 18000u);
+  for (int i = 19900; i < 20000; ++i) {
+    EXPECT_EQ(dou.index_of(i), static_cast<size_t>(i - 19900));
+  }
+}
+
+TEST(DequeOfUniqueTest, BatchedLookups) {
+  deque_of_unique<int, std::hash<int>, std::equal_to<int>, std::allocator<int>,
+                  bloom_filter<flat_index>>
+      dou;
+  for (int i = 0; i < 500; ++i) {
+    dou.push_back(i);
+    dou.push_front(-i - 1);
+  }
+  std::vector<int> keys = {-500, -1, 0, 499, 500, -501, 250};
+  std::uint64_t bits = 0;
+  dou.contains_batch(keys.begin(), keys.end(), &bits);
+  EXPECT_EQ(bits, 0x4Fu);
+  std::vector<int> positions;
+  std::vector<decltype(dou)::const_iterator> found(keys.size());
+  EXPECT_EQ(dou.find_batch(keys.begin(), keys.end(), found.begin()),
+            found.end());
+  for (auto it : found) {
+    positions.push_back(it == dou.cend() ? -1
+                                         : static_cast<int>(it - dou.cbegin()));
+  }
+  EXPECT_EQ(positions, std::vector<int>({0, 499, 500, 999, -1, -1, 750}));
+}
@@ -0,0 +1,82 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "dequeofunique.h"
+#include "parallelbuild.h"
+#include "vectorofunique.h"
+
+using namespace containerofunique;
+
+// n values drawn from [0, distinct), so most inputs repeat values.
+std::vector<int> random_input(std::size_t n, int distinct) {
+  std::mt19937 rng(7);
+  std::uniform_int_distribution<int> dist(0, distinct - 1);
+  std::vector<int> input(n);
+  for (auto& v : input) {
+    v = dist(rng);
+  }
+  return input;
+}
+
+TEST(ParallelBuildTest, MatchesSequentialConstructor) {
+  for (int distinct : {10, 50000, 1000000}) {
+    auto input = random_input(200000, distinct);
+    vector_of_unique<int> expected(input.begin(), input.end());
+    for (std::size_t threads : {0, 1, 2, 3, 8}) {
+      auto built =
+          parallel_build<vector_of_unique<int>>(input.begin(), input.end(),
+                                                threads);
+      EXPECT_EQ(built, expected) << distinct << " " << threads;
+      for (std::size_t i = 0; i < built.size(); i += 997) {
+        EXPECT_EQ(built.index_of(built[i]), i);
+      }
+    }
+  }
+}
+
+TEST(ParallelBuildTest, DequeAndStrings) {
+  std::vector<std::string> input;
+  for (int v : random_input(100000, 30000)) {
+    input.push_back("value-" + std::to_string(v));
+  }
+  deque_of_unique<std::string> expected(input.begin(), input.end());
+  auto built = parallel_build<deque_of_unique<std::string>>(input.begin(),
+                                                            input.end(), 4);
+  EXPECT_EQ(built, expected);
+  EXPECT_FALSE(built.push_back(input.back()));
+}
+
+TEST(ParallelBuildTest, SmallInputsAreBuiltSerially) {
+  std::vector<int> input = {3, 1, 3, 2, 1};
+  auto built =
+      parallel_build<vector_of_unique<int>>(input.begin(), input.end(), 8);
+  EXPECT_EQ(built.vector(), std::vector<int>({3, 1, 2}));
+  auto empty =
+      parallel_build<vector_of_unique<int>>(input.begin(), input.begin(), 8);
+  EXPECT_TRUE(empty.empty());
+}
+
+struct ThrowingHash {
+  size_t operator()(int x) const {
+    if (x == 12345) {
+      throw std::runtime_error("bad value");
+    }
+    return std::hash<int>()(x);
+  }
+};
+
+TEST(ParallelBuildTest, RethrowsWorkerExceptions) {
+  std::vector<int> input(100000);
+  for (std::size_t i = 0; i < input.size(); ++i) {
+    input[i] = static_cast<int>(i);
+  }
+  EXPECT_THROW((parallel_build<vector_of_unique<int, ThrowingHash>>(
+                   input.begin(), input.end(), 4)),
+               std::runtime_error);
+}
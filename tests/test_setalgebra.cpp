@@ -0,0 +1,143 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "setalgebra.h"
+
+using namespace containerofunique;
+
+template <class Container>
+void expect_indexed(const Container& c) {
+  for (std::size_t i = 0; i < c.size(); ++i) {
+    EXPECT_EQ(c.index_of(c[i]), i);
+  }
+}
+
+TEST(SetAlgebraTest, FreeFunctionsKeepLeftOrder) {
+  const vector_of_unique<std::string> lhs = {"d", "a", "c", "b"};
+  const vector_of_unique<std::string> rhs = {"b", "e", "d"};
+
+  auto u = set_union(lhs, rhs);
+  auto i = set_intersection(lhs, rhs);
+  auto d = set_difference(lhs, rhs);
+  EXPECT_EQ(u, vector_of_unique<std::string>({"d", "a", "c", "b", "e"}));
+  EXPECT_EQ(i, vector_of_unique<std::string>({"d", "b"}));
+  EXPECT_EQ(d, vector_of_unique<std::string>({"a", "c"}));
+  expect_indexed(u);
+  expect_indexed(i);
+  expect_indexed(d);
+
+  // Swapping the operands switches which side is probed.
+  EXPECT_EQ(set_intersection(rhs, lhs),
+            vector_of_unique<std::string>({"b", "d"}));
+  EXPECT_EQ(set_difference(rhs, lhs), vector_of_unique<std::string>({"e"}));
+  EXPECT_TRUE(set_intersection(lhs, vector_of_unique<std::string>()).empty());
+  EXPECT_EQ(set_difference(lhs, lhs).size(), 0u);
+  EXPECT_EQ(set_union(lhs, lhs), lhs);
+}
+
+TEST(SetAlgebraTest, MixedContainers) {
+  const vector_of_unique<int> vou = {5, 1, 4, 2};
+  deque_of_unique<int> dou = {4, 8};
+  dou.push_front(2);
+
+  EXPECT_EQ(set_union(vou, dou), vector_of_unique<int>({5, 1, 4, 2, 8}));
+  EXPECT_EQ(set_intersection(dou, vou), deque_of_unique<int>({2, 4}));
+  EXPECT_EQ(set_difference(dou, vou), deque_of_unique<int>({8}));
+
+  auto copy = vou;
+  EXPECT_EQ(copy.subtract(dou), 2u);
+  EXPECT_EQ(copy, vector_of_unique<int>({5, 1}));
+  EXPECT_EQ(dou.merge_from(vou), 2u);
+  EXPECT_EQ(dou, deque_of_unique<int>({2, 4, 8, 5, 1}));
+  EXPECT_EQ(dou.intersect_with(vou), 1u);
+  EXPECT_EQ(dou, deque_of_unique<int>({2, 4, 5, 1}));
+  expect_indexed(dou);
+}
+
+// Agrees with std::equal_to<int>, but throws on 9 once armed.
+struct ThrowingEq {
+  static bool armed;
+  bool operator()(int a, int b) const {
+    if (armed && (a == 9 || b == 9)) {
+      throw std::runtime_error("equality");
+    }
+    return a == b;
+  }
+};
+bool ThrowingEq::armed = false;
+
+template <class Container>
+void expect_throwing_probe_leaves_intact() {
+  // other is the larger side, so each element of c probes other.
+  Container c = {1, 3, 5, 7, 9};
+  deque_of_unique<int, std::hash<int>, ThrowingEq> other;
+  for (int i = 0; i < 10; ++i) {
+    other.push_back(i * 3);
+  }
+  ThrowingEq::armed = true;
+  EXPECT_THROW(c.intersect_with(other), std::runtime_error);
+  EXPECT_THROW(c.subtract(other), std::runtime_error);
+  ThrowingEq::armed = false;
+  EXPECT_EQ(c, Container({1, 3, 5, 7, 9}));
+  expect_indexed(c);
+  EXPECT_EQ(c.subtract(other), 2u);
+  EXPECT_EQ(c, Container({1, 5, 7}));
+  expect_indexed(c);
+}
+
+TEST(SetAlgebraTest, ThrowingProbeLeavesContainerIntact) {
+  expect_throwing_probe_leaves_intact<vector_of_unique<int>>();
+  expect_throwing_probe_leaves_intact<deque_of_unique<int>>();
+}
+
+TEST(SetAlgebraTest, MatchesReferenceOnRandomSets) {
+  using Cached = vector_of_unique<int, std::hash<int>, std::equal_to<int>,
+                                  std::allocator<int>, cached_hash<>>;
+  std::mt19937 rng(3);
+  for (int round = 0; round < 50; ++round) {
+    std::uniform_int_distribution<int> value(0, 200);
+    Cached lhs;
+    deque_of_unique<int> rhs;
+    auto lhs_size = rng() % 150;
+    auto rhs_size = rng() % 150;
+    for (std::size_t k = 0; k < lhs_size; ++k) {
+      lhs.push_back(value(rng));
+    }
+    for (std::size_t k = 0; k < rhs_size; ++k) {
+      rhs.push_front(value(rng));
+    }
+    std::set<int> in_rhs(rhs.begin(), rhs.end());
+
+    std::vector<int> inter;
+    std::vector<int> diff;
+    for (int x : lhs) {
+      (in_rhs.count(x) != 0 ? inter : diff).push_back(x);
+    }
+    auto i = set_intersection(lhs, rhs);
+    auto d = set_difference(lhs, rhs);
+    EXPECT_EQ(i.vector(), inter);
+    EXPECT_EQ(d.vector(), diff);
+    expect_indexed(i);
+    expect_indexed(d);
+
+    auto m = lhs;
+    m.intersect_with(rhs);
+    EXPECT_EQ(m.vector(), inter);
+    m = lhs;
+    m.subtract(rhs);
+    EXPECT_EQ(m.vector(), diff);
+    expect_indexed(m);
+    m.merge_from(rhs);
+    EXPECT_EQ(m.size(), diff.size() + rhs.size());
+    expect_indexed(m);
+  }
+}
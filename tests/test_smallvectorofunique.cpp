@@ -0,0 +1,206 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "smallvectorofunique.h"
+
+using namespace containerofunique;
+
+template <class C>
+std::vector<typename C::value_type> contents(const C& c) {
+  return std::vector<typename C::value_type>(c.begin(), c.end());
+}
+
+TEST(SmallVectorOfUniqueTest, DefaultConstructor) {
+  small_vector_of_unique<int, 4> svou;
+  EXPECT_TRUE(svou.empty());
+  EXPECT_TRUE(svou.is_inline());
+  EXPECT_EQ(svou.capacity(), 4u);
+  EXPECT_EQ(svou.begin(), svou.end());
+  EXPECT_EQ(svou.find(1), svou.cend());
+}
+
+TEST(SmallVectorOfUniqueTest, StaysInlineUpToN) {
+  small_vector_of_unique<int, 4> svou;
+  EXPECT_TRUE(svou.push_back(3));
+  EXPECT_TRUE(svou.push_back(1));
+  EXPECT_FALSE(svou.push_back(3));
+  EXPECT_TRUE(svou.emplace_back(4));
+  EXPECT_FALSE(svou.emplace_back(1));
+  EXPECT_TRUE(svou.push_back(2));
+  EXPECT_FALSE(svou.push_back(4));
+  EXPECT_TRUE(svou.is_inline());
+  EXPECT_EQ(contents(svou), std::vector<int>({3, 1, 4, 2}));
+  EXPECT_EQ(svou.index_of(4), 2u);
+  EXPECT_EQ(svou.index_of(5), svou.npos);
+  EXPECT_EQ(*svou.find(2), 2);
+  EXPECT_EQ(svou.at(1), 1);
+  EXPECT_THROW(svou.at(4), std::out_of_range);
+  EXPECT_EQ(svou.front(), 3);
+  EXPECT_EQ(svou.back(), 2);
+}
+
+TEST(SmallVectorOfUniqueTest, SpillsPastNAndKeepsOrder) {
+  small_vector_of_unique<std::string, 3> svou({"c", "a", "c", "b"});
+  EXPECT_TRUE(svou.is_inline());
+  EXPECT_TRUE(svou.push_back("d"));
+  EXPECT_FALSE(svou.is_inline());
+  EXPECT_FALSE(svou.push_back("a"));
+  for (int i = 0; i < 100; ++i) {
+    svou.emplace_back(std::to_string(i));
+  }
+  EXPECT_FALSE(svou.emplace_back("7"));
+  EXPECT_EQ(svou.size(), 104u);
+  EXPECT_EQ(svou[3], "d");
+  EXPECT_EQ(svou.index_of("42"), 46u);
+  EXPECT_EQ(svou.find("e"), svou.cend());
+  std::vector<std::string> expected = {"c", "a", "b", "d"};
+  for (int i = 0; i < 100; ++i) {
+    expected.push_back(std::to_string(i));
+  }
+  EXPECT_EQ(contents(svou), expected);
+}
+
+TEST(SmallVectorOfUniqueTest, EraseAndRemoveIfKeepOrder) {
+  small_vector_of_unique<int, 8> svou({1, 2, 3, 4, 5, 6});
+  auto it = svou.erase(svou.find(2));
+  EXPECT_EQ(*it, 3);
+  EXPECT_EQ(erase(svou, 5), 1u);
+  EXPECT_EQ(erase(svou, 5), 0u);
+  EXPECT_EQ(contents(svou), std::vector<int>({1, 3, 4, 6}));
+  EXPECT_EQ(erase_if(svou, [](int v) { return v % 3 == 0; }), 2u);
+  EXPECT_EQ(contents(svou), std::vector<int>({1, 4}));
+  EXPECT_TRUE(svou.push_back(3));
+  svou.pop_back();
+  EXPECT_EQ(contents(svou), std::vector<int>({1, 4}));
+
+  for (int i = 10; i < 20; ++i) {
+    svou.push_back(i);
+  }
+  EXPECT_FALSE(svou.is_inline());
+  svou.erase(svou.begin());
+  EXPECT_EQ(svou.remove_if([](int v) { return v >= 12; }), 8u);
+  EXPECT_EQ(contents(svou), std::vector<int>({4, 10, 11}));
+  EXPECT_EQ(svou.index_of(11), 2u);
+}
+
+TEST(SmallVectorOfUniqueTest, ShrinkToFitBringsElementsBackInline) {
+  small_vector_of_unique<std::string, 4> svou;
+  for (int i = 0; i < 10; ++i) {
+    svou.push_back(std::to_string(i));
+  }
+  svou.shrink_to_fit();
+  EXPECT_FALSE(svou.is_inline());
+  erase_if(svou, [](const std::string& s) { return s < "7"; });
+  svou.shrink_to_fit();
+  EXPECT_TRUE(svou.is_inline());
+  EXPECT_EQ(contents(svou), std::vector<std::string>({"7", "8", "9"}));
+  EXPECT_FALSE(svou.push_back("8"));
+  EXPECT_TRUE(svou.push_back("6"));
+  EXPECT_TRUE(svou.is_inline());
+
+  // clear() keeps the elements where they are, like std::vector.
+  svou.reserve(5);
+  EXPECT_FALSE(svou.is_inline());
+  EXPECT_EQ(svou.index_of("6"), 3u);
+  svou.clear();
+  EXPECT_FALSE(svou.is_inline());
+  svou.shrink_to_fit();
+  EXPECT_TRUE(svou.is_inline());
+}
+
+TEST(SmallVectorOfUniqueTest, CopyAndMoveInlineAndSpilled) {
+  for (int n : {3, 30}) {
+    small_vector_of_unique<std::string, 4> svou;
+    for (int i = 0; i < n; ++i) {
+      svou.push_back(std::to_string(i));
+    }
+    auto copy = svou;
+    EXPECT_EQ(copy, svou);
+    EXPECT_EQ(copy.is_inline(), svou.is_inline());
+    EXPECT_FALSE(copy.push_back("2"));
+
+    auto moved = std::move(copy);
+    EXPECT_EQ(moved, svou);
+    EXPECT_TRUE(copy.empty());
+    EXPECT_TRUE(copy.push_back("x"));
+
+    small_vector_of_unique<std::string, 4> other({"a", "b"});
+    other = moved;
+    EXPECT_EQ(other, svou);
+    other = {"y", "z", "y"};
+    EXPECT_EQ(contents(other), std::vector<std::string>({"y", "z"}));
+    other.swap(moved);
+    EXPECT_EQ(moved.size(), 2u);
+    EXPECT_EQ(other, svou);
+    moved = std::move(other);
+    EXPECT_EQ(moved, svou);
+    EXPECT_NE(moved, copy);
+    EXPECT_EQ(*moved.find("1"), "1");
+  }
+}
+
+TEST(SmallVectorOfUniqueTest, FlatIndexPolicy) {
+  small_vector_of_unique<int, 2, std::hash<int>, std::equal_to<int>,
+                         std::allocator<int>, flat_index>
+      svou;
+  for (int i = 0; i < 1000; ++i) {
+    svou.push_back(i % 300);
+  }
+  EXPECT_EQ(svou.size(), 300u);
+  for (int i = 0; i < 300; ++i) {
+    EXPECT_EQ(svou.index_of(i), static_cast<std::size_t>(i));
+  }
+}
+
+#if __cplusplus >= 201703L
+// memory_resource that counts the allocations made through it.
+class CountingResource : public std::pmr::memory_resource {
+ public:
+  size_t allocations = 0;
+
+ private:
+  void* do_allocate(size_t bytes, size_t alignment) override {
+    ++allocations;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+  void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+  }
+  bool do_is_equal(
+      const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+};
+
+TEST(SmallVectorOfUniqueTest, SmallInstancesDoNotAllocate) {
+  CountingResource resource;
+  using small =
+      small_vector_of_unique<int, 16, std::hash<int>, std::equal_to<int>,
+                             std::pmr::polymorphic_allocator<int>>;
+  for (int round = 0; round < 100; ++round) {
+    small svou(&resource);
+    for (int i = 0; i < 40; ++i) {
+      svou.push_back(i % 16);
+    }
+    auto copy = svou;
+    svou.erase(svou.begin());
+    EXPECT_EQ(copy.size(), 16u);
+  }
+  EXPECT_EQ(resource.allocations, 0u);
+
+  small svou(&resource);
+  for (int i = 0; i < 17; ++i) {
+    svou.push_back(i);
+  }
+  EXPECT_FALSE(svou.is_inline());
+  EXPECT_NE(resource.allocations, 0u);
+}
+#endif
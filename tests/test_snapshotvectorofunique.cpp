@@ -0,0 +1,158 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "snapshotvectorofunique.h"
+
+using namespace containerofunique;
+
+// Element that counts its live instances, so tests can tell when old
+// versions are freed.
+struct Tracked {
+  static int alive;
+  int value;
+  Tracked(int v) : value(v) { ++alive; }  // NOLINT(runtime/explicit)
+  Tracked(const Tracked& other) : value(other.value) { ++alive; }
+  Tracked& operator=(const Tracked&) = default;
+  ~Tracked() { --alive; }
+  bool operator==(const Tracked& other) const { return value == other.value; }
+};
+int Tracked::alive = 0;
+
+struct TrackedHash {
+  size_t operator()(const Tracked& t) const {
+    return std::hash<int>()(t.value);
+  }
+};
+
+using TrackedSnapshot = snapshot_vector_of_unique<Tracked, TrackedHash>;
+
+TEST(SnapshotVectorOfUniqueTest, WritersPublishNewVersions) {
+  snapshot_vector_of_unique<std::string> svou;
+  EXPECT_TRUE(svou.empty());
+  EXPECT_TRUE(svou.push_back("a"));
+  EXPECT_TRUE(svou.push_back("b"));
+  EXPECT_FALSE(svou.push_back("a"));
+  EXPECT_EQ(svou.size(), 2u);
+  EXPECT_EQ(svou.index_of("b"), 1u);
+  EXPECT_EQ(svou.erase("a"), 1u);
+  EXPECT_EQ(svou.erase("a"), 0u);
+  svou.update([](vector_of_unique<std::string>& v) {
+    v.push_back("c");
+    v.push_back("b");
+    v.push_back("d");
+  });
+  EXPECT_EQ(svou.read()->vector(), std::vector<std::string>({"b", "c", "d"}));
+#if __cplusplus >= 202002L
+  EXPECT_TRUE(svou.contains("c"));
+  EXPECT_FALSE(svou.contains("a"));
+#endif
+  svou.publish({"x", "y"});
+  EXPECT_EQ(svou.index_of("y"), 1u);
+  svou.clear();
+  EXPECT_TRUE(svou.empty());
+}
+
+TEST(SnapshotVectorOfUniqueTest, SnapshotsAreImmutable) {
+  snapshot_vector_of_unique<int> svou(vector_of_unique<int>({1, 2, 3}));
+  auto snap = svou.snapshot();
+  auto guard = svou.read();
+  svou.push_back(4);
+  svou.erase(1);
+  EXPECT_EQ(snap->vector(), std::vector<int>({1, 2, 3}));
+  EXPECT_EQ(guard->vector(), std::vector<int>({1, 2, 3}));
+  EXPECT_EQ(svou.read()->vector(), std::vector<int>({2, 3, 4}));
+  auto moved = std::move(guard);
+  EXPECT_EQ((*moved).size(), 3u);
+}
+
+TEST(SnapshotVectorOfUniqueTest, PinnedVersionsAreReclaimedAfterRelease) {
+  Tracked::alive = 0;
+  {
+    TrackedSnapshot svou(4);
+    for (int i = 0; i < 3; ++i) {
+      svou.push_back(i);
+    }
+    EXPECT_EQ(svou.retired(), 0u);
+    EXPECT_EQ(Tracked::alive, 3);
+    {
+      auto guard = svou.read();
+      svou.push_back(3);
+      svou.push_back(4);
+      // The pinned version {0, 1, 2} and the unpinned {0, 1, 2, 3} after it
+      // are both kept, since the reader pinned before either was retired.
+      EXPECT_EQ(svou.retired(), 2u);
+      EXPECT_EQ(Tracked::alive, 3 + 4 + 5);
+      EXPECT_EQ(guard->size(), 3u);
+    }
+    svou.push_back(5);
+    EXPECT_EQ(svou.retired(), 0u);
+    EXPECT_EQ(Tracked::alive, 6);
+
+    // A shared_ptr snapshot keeps its version alive without pinning it.
+    auto snap = svou.snapshot();
+    svou.push_back(6);
+    EXPECT_EQ(svou.retired(), 0u);
+    EXPECT_EQ(Tracked::alive, 6 + 7);
+    snap.reset();
+    EXPECT_EQ(Tracked::alive, 7);
+  }
+  EXPECT_EQ(Tracked::alive, 0);
+}
+
+TEST(SnapshotVectorOfUniqueTest, MoreGuardsThanSlots) {
+  snapshot_vector_of_unique<int> svou(2);
+  EXPECT_EQ(svou.reader_slots(), 2u);
+  auto g1 = svou.read();
+  auto g2 = svou.read();
+  std::thread t([&] {
+    // Waits for a slot until g1 is released below.
+    auto g3 = svou.read();
+    EXPECT_TRUE(g3->empty());
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  { auto released = std::move(g1); }
+  t.join();
+}
+
+TEST(SnapshotVectorOfUniqueTest, ConcurrentReadersAndWriter) {
+  constexpr int values = 2000;
+  TrackedSnapshot svou(8);
+  std::atomic<bool> done{false};
+  std::atomic<int> bad{0};
+  std::vector<std::thread> readers;
+  for (int r = 0; r < 4; ++r) {
+    readers.emplace_back([&] {
+      while (!done.load()) {
+        auto guard = svou.read();
+        // Every version is a prefix 0..n-1 with a consistent index.
+        int expected = 0;
+        for (const auto& t : *guard) {
+          if (t.value != expected ||
+              guard->index_of(t) != static_cast<size_t>(expected)) {
+            ++bad;
+          }
+          ++expected;
+        }
+      }
+    });
+  }
+  for (int i = 0; i < values; ++i) {
+    svou.push_back(i);
+  }
+  done = true;
+  for (auto& r : readers) {
+    r.join();
+  }
+  EXPECT_EQ(bad.load(), 0);
+  EXPECT_EQ(svou.size(), static_cast<size_t>(values));
+  svou.push_back(values);
+  EXPECT_EQ(svou.retired(), 0u);
+}
@@ -3,9 +3,15 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <array>
 #include <compare>
 #include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory_resource>
 #include <numeric>
+#include <sstream>
 #include <stdexcept>
 #include <string_view>
 #include <unordered_set>
@@ -1657,3 +1663,943 @@ TEST(VectorOfUniqueTest, AppendRange_EmptyRange) {
   EXPECT_EQ(vou.vector(), std::vector<int>({1, 2}));
 }
 #endif
+
+// Tests for index-based storage
+struct CopyCounted {
+  static int copies;
+  static int moves;
+  int value;
+
+  explicit CopyCounted(int v) : value(v) {}
+  CopyCounted(const CopyCounted& other) : value(other.value) { ++copies; }
+  CopyCounted(CopyCounted&& other) noexcept : value(other.value) { ++moves; }
+  CopyCounted& operator=(const CopyCounted& other) {
+    value = other.value;
+    ++copies;
+    return *this;
+  }
+  CopyCounted& operator=(CopyCounted&& other) noexcept {
+    value = other.value;
+    ++moves;
+    return *this;
+  }
+  ~CopyCounted() = default;
+
+  bool operator==(const CopyCounted& other) const {
+    return value == other.value;
+  }
+};
+int CopyCounted::copies = 0;
+int CopyCounted::moves = 0;
+
+struct CopyCountedHash {
+  size_t operator()(const CopyCounted& c) const {
+    return std::hash<int>{}(c.value);
+  }
+};
+
+TEST(VectorOfUniqueTest, PushBack_StoresSingleCopy) {
+  vector_of_unique<CopyCounted, CopyCountedHash> vou;
+  const CopyCounted a(1);
+  const CopyCounted b(2);
+  CopyCounted::copies = 0;
+  EXPECT_TRUE(vou.push_back(a));
+  EXPECT_TRUE(vou.push_back(b));
+  EXPECT_FALSE(vou.push_back(a));
+  EXPECT_EQ(CopyCounted::copies, 2);
+  EXPECT_EQ(vou.size(), 2u);
+}
+
+TEST(VectorOfUniqueTest, InsertRange_MovesTailOnce) {
+  vector_of_unique<CopyCounted, CopyCountedHash> vou;
+  for (int i = 0; i < 1000; ++i) {
+    vou.push_back(CopyCounted(i));
+  }
+  std::vector<CopyCounted> input;
+  for (int i = 0; i < 200; ++i) {
+    // Every other element is already present.
+    input.emplace_back(i % 2 == 0 ? 1000 + i : i);
+  }
+  CopyCounted::copies = 0;
+  CopyCounted::moves = 0;
+  auto it = vou.insert(vou.cbegin() + 500, input.begin(), input.end());
+  EXPECT_EQ(it, vou.cbegin() + 500);
+  EXPECT_EQ(CopyCounted::copies, 100);
+  // Inserting one element at a time would move the 500-element tail for
+  // each of the 100.
+  EXPECT_LT(CopyCounted::moves, 3 * 1100);
+  ASSERT_EQ(vou.size(), 1100u);
+  for (int i = 0; i < 1100; ++i) {
+    int expected = i < 500 ? i : i < 600 ? 1000 + 2 * (i - 500) : i - 100;
+    EXPECT_EQ(vou[i].value, expected);
+    EXPECT_EQ(vou.index_of(CopyCounted(expected)), static_cast<size_t>(i));
+  }
+  it = vou.insert(vou.cbegin() + 7, input.begin(), input.end());
+  EXPECT_EQ(it, vou.cbegin() + 7);
+}
+
+TEST(VectorOfUniqueTest, InsertRange_SmallBatchesGrowGeometrically) {
+  vector_of_unique<int> vou;
+  for (int i = 0; i < 1000; ++i) {
+    vou.push_back(i);
+  }
+  int reallocations = 0;
+  int rehashes = 0;
+  for (int i = 1000; i < 9000; i += 2) {
+    auto capacity = vou.capacity();
+    auto buckets = vou.bucket_count();
+    const int batch[] = {i, i + 1, i};
+    vou.insert(vou.cbegin() + 500, std::begin(batch), std::end(batch));
+    reallocations += vou.capacity() != capacity ? 1 : 0;
+    rehashes += vou.bucket_count() != buckets ? 1 : 0;
+  }
+  ASSERT_EQ(vou.size(), 9000u);
+  EXPECT_LE(reallocations, 4);
+  EXPECT_LE(rehashes, 8);
+  EXPECT_EQ(vou.index_of(8999), 501u);
+  EXPECT_EQ(vou.index_of(999), 8999u);
+}
+
+TEST(VectorOfUniqueTest, PushBack_RvalueMakesNoCopy) {
+  vector_of_unique<CopyCounted, CopyCountedHash> vou;
+  CopyCounted::copies = 0;
+  EXPECT_TRUE(vou.push_back(CopyCounted(1)));
+  EXPECT_TRUE(vou.push_back(CopyCounted(2)));
+  EXPECT_FALSE(vou.push_back(CopyCounted(1)));
+  EXPECT_EQ(CopyCounted::copies, 0);
+}
+
+TEST(VectorOfUniqueTest, Find_PositionsTrackMiddleInsertAndErase) {
+  vector_of_unique<std::string> vou = {"a", "b", "c", "d", "e"};
+  vou.erase(vou.cbegin() + 1);
+  vou.insert(vou.cbegin(), "x");
+  vou.erase(vou.cbegin() + 2, vou.cbegin() + 4);
+  ASSERT_EQ(vou.vector(), (std::vector<std::string>{"x", "a", "e"}));
+  for (size_t i = 0; i < vou.size(); ++i) {
+    EXPECT_EQ(vou.find(vou[i]), vou.cbegin() + static_cast<std::ptrdiff_t>(i));
+  }
+  EXPECT_EQ(vou.find("b"), vou.cend());
+  EXPECT_EQ(vou.find("c"), vou.cend());
+  EXPECT_EQ(vou.find("d"), vou.cend());
+  EXPECT_TRUE(vou.push_back("c"));
+  EXPECT_EQ(vou.find("c"), vou.cend() - 1);
+}
+
+TEST(VectorOfUniqueTest, SetView_LooksUpThroughIndex) {
+  vector_of_unique<std::string> vou = {"hello", "world"};
+  auto set = vou.set();
+  EXPECT_EQ(set.size(), 2u);
+  EXPECT_EQ(set.count("hello"), 1u);
+  EXPECT_EQ(set.count("missing"), 0u);
+  EXPECT_EQ(*set.find("world"), "world");
+  EXPECT_EQ(set.find("missing"), set.end());
+  vou.pop_back();
+  EXPECT_EQ(set.size(), 1u);
+  EXPECT_EQ(set.count("world"), 0u);
+}
+
+TEST(VectorOfUniqueTest, IndexOf) {
+  vector_of_unique<std::string> vou = {"a", "b", "c"};
+  EXPECT_EQ(vou.index_of("a"), 0u);
+  EXPECT_EQ(vou.index_of("c"), 2u);
+  EXPECT_EQ(vou.index_of("z"), vector_of_unique<std::string>::npos);
+  vou.erase(vou.cbegin());
+  EXPECT_EQ(vou.index_of("a"), vector_of_unique<std::string>::npos);
+  EXPECT_EQ(vou.index_of("c"), 1u);
+}
+
+#if __cplusplus >= 202002L
+TEST(VectorOfUniqueTest, IndexOf_HeterogeneousLookup) {
+  vector_of_unique<std::string, StringHash, StringEqual> vou = {"hello",
+                                                                "world"};
+  EXPECT_EQ(vou.index_of(std::string_view("world")), 1u);
+  EXPECT_EQ(vou.index_of(std::string_view("foo")),
+            (vector_of_unique<std::string, StringHash, StringEqual>::npos));
+}
+#endif
+
+TEST(VectorOfUniqueTest, EraseIf_CallsPredicateOncePerElement) {
+  vector_of_unique<int> vou = {1, 2, 3, 4, 5, 6, 7, 8};
+  int calls = 0;
+  auto removed = erase_if(vou, [&calls](int x) {
+    ++calls;
+    return x % 3 != 0;
+  });
+  EXPECT_EQ(removed, 6u);
+  EXPECT_EQ(calls, 8);
+  EXPECT_EQ(vou.vector(), std::vector<int>({3, 6}));
+}
+
+TEST(VectorOfUniqueTest, EraseIf_KeepsIndexConsistent) {
+  std::vector<int> src(1000);
+  std::iota(src.begin(), src.end(), 0);
+  vector_of_unique<int> vou(src.begin(), src.end());
+  auto removed = erase_if(vou, [](int x) { return x % 10 < 3; });
+  EXPECT_EQ(removed, 300u);
+  ASSERT_EQ(vou.size(), 700u);
+  EXPECT_EQ(vou.set().size(), 700u);
+  for (size_t i = 0; i < vou.size(); ++i) {
+    EXPECT_EQ(vou.index_of(vou[i]), i);
+  }
+  EXPECT_EQ(vou.find(12), vou.cend());
+  EXPECT_TRUE(vou.push_back(12));
+  EXPECT_FALSE(vou.push_back(13));
+}
+
+TEST(VectorOfUniqueTest, EraseIf_ThrowingPredicateLeavesContainerIntact) {
+  vector_of_unique<std::string> vou;
+  for (int i = 0; i < 10; ++i) {
+    vou.push_back(std::to_string(i));
+  }
+  int calls = 0;
+  EXPECT_THROW(erase_if(vou,
+                        [&](const std::string& s) {
+                          if (++calls == 6) {
+                            throw std::runtime_error("predicate");
+                          }
+                          return s == "1" || s == "3";
+                        }),
+               std::runtime_error);
+  ASSERT_EQ(vou.size(), 10u);
+  for (size_t i = 0; i < vou.size(); ++i) {
+    EXPECT_EQ(vou[i], std::to_string(i));
+    EXPECT_EQ(vou.index_of(vou[i]), i);
+  }
+  EXPECT_FALSE(vou.push_back("5"));
+  EXPECT_EQ(erase_if(vou, [](const std::string& s) { return s == "1"; }), 1u);
+  EXPECT_EQ(vou.index_of("9"), 8u);
+}
+
+TEST(VectorOfUniqueTest, RemoveIf_Member) {
+  vector_of_unique<std::string> vou = {"apple", "banana", "avocado", "cherry"};
+  EXPECT_EQ(vou.remove_if([](const std::string& s) { return s[0] == 'a'; }),
+            2u);
+  EXPECT_EQ(vou.vector(), (std::vector<std::string>{"banana", "cherry"}));
+  EXPECT_EQ(vou.index_of("cherry"), 1u);
+}
+
+TEST(VectorOfUniqueTest, UnorderedErase_MovesLastIntoHole) {
+  vector_of_unique<std::string> vou = {"a", "b", "c", "d"};
+  auto it = vou.unordered_erase(vou.cbegin() + 1);
+  EXPECT_EQ(vou.vector(), (std::vector<std::string>{"a", "d", "c"}));
+  EXPECT_EQ(*it, "d");
+  EXPECT_EQ(vou.index_of("d"), 1u);
+  EXPECT_EQ(vou.find("b"), vou.cend());
+  EXPECT_EQ(vou.set().size(), 3u);
+}
+
+TEST(VectorOfUniqueTest, UnorderedErase_LastElement) {
+  vector_of_unique<int> vou = {1, 2, 3};
+  auto it = vou.unordered_erase(vou.cend() - 1);
+  EXPECT_EQ(it, vou.cend());
+  EXPECT_EQ(vou.vector(), std::vector<int>({1, 2}));
+  EXPECT_TRUE(vou.push_back(3));
+}
+
+TEST(VectorOfUniqueTest, UnorderedErase_ByKey) {
+  vector_of_unique<int> vou = {10, 20, 30, 40};
+  EXPECT_EQ(vou.unordered_erase(10), 1u);
+  EXPECT_EQ(vou.unordered_erase(10), 0u);
+  EXPECT_EQ(vou.unordered_erase(99), 0u);
+  EXPECT_EQ(vou.vector(), std::vector<int>({40, 20, 30}));
+  for (size_t i = 0; i < vou.size(); ++i) {
+    EXPECT_EQ(vou.index_of(vou[i]), i);
+  }
+  EXPECT_EQ(vou.unordered_erase(30), 1u);
+  EXPECT_EQ(vou.unordered_erase(40), 1u);
+  EXPECT_EQ(vou.unordered_erase(20), 1u);
+  EXPECT_TRUE(vou.empty());
+  EXPECT_TRUE(vou.set().empty());
+}
+
+TEST(VectorOfUniqueTest, Reserve_SizesVectorAndIndex) {
+  vector_of_unique<int> vou;
+  vou.reserve(1000);
+  EXPECT_GE(vou.capacity(), 1000u);
+  EXPECT_GE(static_cast<float>(vou.bucket_count()) * vou.max_load_factor(),
+            1000.0f);
+  auto capacity = vou.capacity();
+  auto buckets = vou.bucket_count();
+  for (int i = 0; i < 1000; ++i) {
+    vou.push_back(i);
+  }
+  EXPECT_EQ(vou.capacity(), capacity);
+  EXPECT_EQ(vou.bucket_count(), buckets);
+}
+
+TEST(VectorOfUniqueTest, ShrinkToFit) {
+  vector_of_unique<int> vou;
+  for (int i = 0; i < 1000; ++i) {
+    vou.push_back(i);
+  }
+  auto buckets = vou.bucket_count();
+  vou.erase(vou.cbegin() + 10, vou.cend());
+  vou.shrink_to_fit();
+  EXPECT_EQ(vou.capacity(), 10u);
+  EXPECT_LT(vou.bucket_count(), buckets);
+  EXPECT_EQ(vou.index_of(9), 9u);
+  EXPECT_EQ(vou.find(10), vou.cend());
+}
+
+TEST(VectorOfUniqueTest, HashPolicy) {
+  vector_of_unique<int> vou = {1, 2, 3, 4};
+  EXPECT_FLOAT_EQ(vou.max_load_factor(), 1.0f);
+  vou.max_load_factor(0.5f);
+  EXPECT_FLOAT_EQ(vou.max_load_factor(), 0.5f);
+  EXPECT_LE(vou.load_factor(), 0.5f);
+  vou.rehash(256);
+  EXPECT_GE(vou.bucket_count(), 256u);
+  EXPECT_FLOAT_EQ(vou.load_factor(),
+                  4.0f / static_cast<float>(vou.bucket_count()));
+  EXPECT_EQ(vou.index_of(3), 2u);
+}
+
+#if __cplusplus >= 201703L
+// memory_resource that counts the bytes allocated through it.
+class CountingResource : public std::pmr::memory_resource {
+ public:
+  size_t allocated = 0;
+
+ private:
+  void* do_allocate(size_t bytes, size_t alignment) override {
+    allocated += bytes;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+  void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+  }
+  bool do_is_equal(
+      const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+};
+
+TEST(VectorOfUniqueTest, Pmr_AllocatesFromResource) {
+  CountingResource resource;
+  pmr::vector_of_unique<std::pmr::string> vou(&resource);
+  EXPECT_EQ(vou.get_allocator().resource(), &resource);
+  vou.push_back("a string long enough to defeat the small string buffer");
+  vou.push_back("b");
+  vou.push_back("b");
+  EXPECT_EQ(vou.size(), 2u);
+  EXPECT_GT(resource.allocated, 0u);
+  EXPECT_EQ(vou[0].get_allocator().resource(), &resource);
+}
+
+TEST(VectorOfUniqueTest, Pmr_MonotonicBuffer) {
+  std::array<std::byte, 4096> buffer{};
+  std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size(),
+                                            std::pmr::null_memory_resource());
+  pmr::vector_of_unique<int> vou({1, 2, 3, 2, 1}, &arena);
+  EXPECT_EQ(vou.size(), 3u);
+  EXPECT_EQ(vou.index_of(3), 2u);
+  EXPECT_EQ(erase(vou, 2), 1u);
+  EXPECT_EQ(vou.index_of(3), 1u);
+}
+
+TEST(VectorOfUniqueTest, Pmr_AllocatorExtendedCopyAndMove) {
+  CountingResource first;
+  CountingResource second;
+  pmr::vector_of_unique<int> vou1({1, 2, 3}, &first);
+
+  pmr::vector_of_unique<int> copy(vou1, &second);
+  EXPECT_EQ(copy.get_allocator().resource(), &second);
+  EXPECT_EQ(copy, vou1);
+
+  // A plain copy does not propagate a polymorphic allocator.
+  // NOLINTNEXTLINE(performance-unnecessary-copy-initialization)
+  pmr::vector_of_unique<int> plain_copy(vou1);
+  EXPECT_EQ(plain_copy.get_allocator().resource(),
+            std::pmr::get_default_resource());
+
+  pmr::vector_of_unique<int> moved(std::move(vou1), &second);
+  EXPECT_EQ(moved.get_allocator().resource(), &second);
+  EXPECT_EQ(moved.index_of(3), 2u);
+  // NOLINTNEXTLINE(bugprone-use-after-move,clang-analyzer-cplusplus.Move)
+  EXPECT_TRUE(vou1.empty());
+  EXPECT_TRUE(moved.push_back(4));
+  EXPECT_FALSE(moved.push_back(1));
+}
+#endif
+
+// Hasher that counts how often it is invoked.
+struct CountingHash {
+  static int calls;
+  size_t operator()(int x) const {
+    ++calls;
+    return std::hash<int>{}(x);
+  }
+};
+int CountingHash::calls = 0;
+
+TEST(VectorOfUniqueTest, CopyConstructor_DoesNotRehash) {
+  vector_of_unique<int, CountingHash> vou1 = {1, 2, 3, 4, 5};
+  CountingHash::calls = 0;
+  // NOLINTNEXTLINE(performance-unnecessary-copy-initialization)
+  vector_of_unique<int, CountingHash> vou2(vou1);
+  EXPECT_EQ(CountingHash::calls, 0);
+  EXPECT_EQ(vou2.vector(), std::vector<int>({1, 2, 3, 4, 5}));
+  EXPECT_EQ(vou2.set().size(), 5u);
+  EXPECT_EQ(vou2.index_of(4), 3u);
+  EXPECT_FALSE(vou2.push_back(5));
+  EXPECT_TRUE(vou2.push_back(6));
+  EXPECT_EQ(vou1.size(), 5u);
+}
+
+TEST(VectorOfUniqueTest, CopyAssignment_DoesNotRehash) {
+  vector_of_unique<int, CountingHash> vou1 = {1, 2, 3};
+  vector_of_unique<int, CountingHash> vou2 = {7, 8};
+  CountingHash::calls = 0;
+  vou2 = vou1;
+  EXPECT_EQ(CountingHash::calls, 0);
+  EXPECT_EQ(vou2, vou1);
+  EXPECT_EQ(vou2.index_of(3), 2u);
+  EXPECT_EQ(vou2.find(7), vou2.cend());
+}
+
+// Tests for move-only and zero-copy insertion
+struct MoveOnly {
+  int value;
+
+  explicit MoveOnly(int v) : value(v) {}
+  MoveOnly(const MoveOnly&) = delete;
+  MoveOnly(MoveOnly&&) noexcept = default;
+  MoveOnly& operator=(const MoveOnly&) = delete;
+  MoveOnly& operator=(MoveOnly&&) noexcept = default;
+  ~MoveOnly() = default;
+
+  bool operator==(const MoveOnly& other) const { return value == other.value; }
+};
+
+struct MoveOnlyHash {
+  size_t operator()(const MoveOnly& m) const {
+    return std::hash<int>{}(m.value);
+  }
+};
+
+TEST(VectorOfUniqueTest, MoveOnly_Modifiers) {
+  vector_of_unique<MoveOnly, MoveOnlyHash> vou;
+  EXPECT_TRUE(vou.push_back(MoveOnly(1)));
+  EXPECT_FALSE(vou.push_back(MoveOnly(1)));
+  vou.emplace_back(3);
+  vou.emplace_back(3);
+  EXPECT_TRUE(vou.insert(vou.cbegin() + 1, MoveOnly(2)).second);
+  EXPECT_FALSE(vou.insert(vou.cbegin(), MoveOnly(3)).second);
+  EXPECT_TRUE(vou.emplace(vou.cbegin(), 0).second);
+  ASSERT_EQ(vou.size(), 4u);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(vou[static_cast<size_t>(i)].value, i);
+    EXPECT_EQ(vou.index_of(MoveOnly(i)), static_cast<size_t>(i));
+  }
+  vou.unordered_erase(vou.cbegin());
+  EXPECT_EQ(erase_if(vou, [](const MoveOnly& m) { return m.value == 2; }), 1u);
+  EXPECT_EQ(vou.size(), 2u);
+  EXPECT_EQ(vou.index_of(MoveOnly(1)), 1u);
+}
+
+TEST(VectorOfUniqueTest, Insert_RvalueMakesNoCopy) {
+  vector_of_unique<CopyCounted, CopyCountedHash> vou;
+  vou.push_back(CopyCounted(1));
+  CopyCounted::copies = 0;
+  EXPECT_TRUE(vou.insert(vou.cbegin(), CopyCounted(0)).second);
+  EXPECT_FALSE(vou.insert(vou.cbegin(), CopyCounted(1)).second);
+  EXPECT_EQ(CopyCounted::copies, 0);
+  EXPECT_EQ(vou.index_of(CopyCounted(1)), 1u);
+}
+
+TEST(VectorOfUniqueTest, EmplaceBack_ConstructsInPlace) {
+  vector_of_unique<CopyCounted, CopyCountedHash> vou;
+  vou.reserve(4);
+  CopyCounted::copies = 0;
+  CopyCounted::moves = 0;
+  vou.emplace_back(1);
+  vou.emplace_back(2);
+  vou.emplace_back(1);
+  EXPECT_EQ(CopyCounted::copies, 0);
+  EXPECT_EQ(CopyCounted::moves, 0);
+  EXPECT_EQ(vou.size(), 2u);
+  EXPECT_EQ(vou.index_of(CopyCounted(2)), 1u);
+}
+
+TEST(VectorOfUniqueTest, Emplace_ConstructsOnce) {
+  vector_of_unique<CopyCounted, CopyCountedHash> vou;
+  vou.reserve(8);
+  vou.emplace_back(1);
+  vou.emplace_back(2);
+  CopyCounted::copies = 0;
+  CopyCounted::moves = 0;
+  auto result = vou.emplace(vou.cend(), 3);
+  EXPECT_TRUE(result.second);
+  EXPECT_EQ(result.first->value, 3);
+  EXPECT_FALSE(vou.emplace(vou.cend(), 1).second);
+  EXPECT_FALSE(vou.emplace(vou.cbegin() + 1, 3).second);
+  EXPECT_EQ(CopyCounted::moves, 0);
+
+  // In the middle, only the one temporary and the two elements after pos
+  // move.
+  result = vou.emplace(vou.cbegin() + 1, 4);
+  EXPECT_TRUE(result.second);
+  EXPECT_EQ(result.first, vou.cbegin() + 1);
+  EXPECT_EQ(CopyCounted::copies, 0);
+  EXPECT_LE(CopyCounted::moves, 3);
+  const std::array<int, 4> expected = {1, 4, 2, 3};
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(vou.index_of(CopyCounted(expected[i])), i);
+  }
+}
+
+TEST(VectorOfUniqueTest, EmplaceBack_DuplicateKeepsStorage) {
+  vector_of_unique<CopyCounted, CopyCountedHash> vou;
+  vou.reserve(2);
+  vou.emplace_back(1);
+  vou.emplace_back(2);
+  ASSERT_EQ(vou.capacity(), vou.size());
+  const auto* data = vou.vector().data();
+  auto first = vou.cbegin();
+  CopyCounted::moves = 0;
+#if __cplusplus >= 201703L
+  EXPECT_FALSE(vou.emplace_back(1).has_value());
+#else
+  vou.emplace_back(1);
+#endif
+  EXPECT_FALSE(vou.emplace(vou.cend(), 2).second);
+  EXPECT_EQ(vou.size(), 2u);
+  // A rejected duplicate reallocates nothing, so iterators stay valid.
+  EXPECT_EQ(vou.vector().data(), data);
+  EXPECT_EQ(vou.capacity(), 2u);
+  EXPECT_EQ(first->value, 1);
+  EXPECT_EQ(CopyCounted::moves, 0);
+#if __cplusplus >= 201703L
+  EXPECT_TRUE(vou.emplace_back(3).has_value());
+#else
+  vou.emplace_back(3);
+#endif
+  EXPECT_EQ(vou.index_of(CopyCounted(3)), 2u);
+}
+
+struct ThrowingIntHash {
+  size_t operator()(int v) const {
+    if (v == 13) {
+      throw std::runtime_error("unlucky");
+    }
+    return std::hash<int>{}(v);
+  }
+};
+
+TEST(VectorOfUniqueTest, EmplaceBack_ThrowingHashLeavesNoElement) {
+  vector_of_unique<int, ThrowingIntHash> vou = {1, 2};
+  vou.reserve(8);
+  EXPECT_THROW(vou.emplace_back(13), std::runtime_error);
+  EXPECT_THROW(vou.emplace(vou.cend(), 13), std::runtime_error);
+  EXPECT_EQ(vou.vector(), std::vector<int>({1, 2}));
+#if __cplusplus >= 201703L
+  EXPECT_TRUE(vou.emplace_back(3).has_value());
+#else
+  vou.emplace_back(3);
+#endif
+  EXPECT_EQ(vou.index_of(3), 2u);
+}
+
+TEST(VectorOfUniqueTest, AppendBulk_SkipsDuplicates) {
+  vector_of_unique<int> vou = {1, 2};
+  std::vector<int> input(200);
+  std::iota(input.begin(), input.end(), 0);
+  input.insert(input.end(), input.begin(), input.begin() + 50);
+  EXPECT_EQ(vou.append_bulk(input.begin(), input.end()), 198u);
+  ASSERT_EQ(vou.size(), 200u);
+  EXPECT_EQ(vou[0], 1);
+  EXPECT_EQ(vou[1], 2);
+  EXPECT_EQ(vou[2], 0);
+  for (int i = 3; i < 200; ++i) {
+    EXPECT_EQ(vou.index_of(i), static_cast<size_t>(i));
+  }
+  EXPECT_EQ(vou.append_bulk(input.begin(), input.end()), 0u);
+}
+
+TEST(VectorOfUniqueTest, AppendBulk_InputIterator) {
+  vector_of_unique<int> vou = {3};
+  std::istringstream in("1 2 3 2 4");
+  EXPECT_EQ(vou.append_bulk(std::istream_iterator<int>(in),
+                            std::istream_iterator<int>()),
+            3u);
+  EXPECT_EQ(vou.vector(), std::vector<int>({3, 1, 2, 4}));
+}
+
+TEST(VectorOfUniqueTest, AppendBulk_MovesFromMoveIterators) {
+  vector_of_unique<std::string> vou;
+  std::vector<std::string> input = {"a", "b", "a"};
+  EXPECT_EQ(vou.append_bulk(std::make_move_iterator(input.begin()),
+                            std::make_move_iterator(input.end())),
+            2u);
+  EXPECT_EQ(vou.index_of("b"), 1u);
+  EXPECT_TRUE(input[1].empty());
+  EXPECT_EQ(input[2], "a");
+}
+
+TEST(VectorOfUniqueTest, InsertBulk_RotatesIntoPlace) {
+  vector_of_unique<int> vou = {1, 2, 3};
+  std::vector<int> input = {7, 2, 8, 7, 9};
+  EXPECT_EQ(vou.insert_bulk(vou.cbegin() + 1, input.begin(), input.end()),
+            3u);
+  ASSERT_EQ(vou.size(), 6u);
+  const std::array<int, 6> expected = {1, 7, 8, 9, 2, 3};
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(vou[i], expected[i]);
+    EXPECT_EQ(vou.index_of(expected[i]), i);
+  }
+  EXPECT_EQ(vou.insert_bulk(vou.cend(), input.begin(), input.end()), 0u);
+}
+
+TEST(VectorOfUniqueTest, SetOperations_KeepOrder) {
+  const vector_of_unique<int> small = {9, 4, 6};
+  const vector_of_unique<int> large = {6, 7, 8, 9, 10, 11};
+  for (const auto* other : {&small, &large}) {
+    vector_of_unique<int> vou = {1, 4, 9, 3, 6, 7};
+    auto inter = vou;
+    auto diff = vou;
+    vou.merge_from(*other);
+    inter.intersect_with(*other);
+    diff.subtract(*other);
+    for (const auto* v : {&vou, &inter, &diff}) {
+      for (size_t i = 0; i < v->size(); ++i) {
+        EXPECT_EQ(v->index_of((*v)[i]), i);
+      }
+    }
+    if (other == &small) {
+      EXPECT_EQ(vou, vector_of_unique<int>({1, 4, 9, 3, 6, 7}));
+      EXPECT_EQ(inter, vector_of_unique<int>({4, 9, 6}));
+      EXPECT_EQ(diff, vector_of_unique<int>({1, 3, 7}));
+    } else {
+      EXPECT_EQ(vou, vector_of_unique<int>({1, 4, 9, 3, 6, 7, 8, 10, 11}));
+      EXPECT_EQ(inter, vector_of_unique<int>({9, 6, 7}));
+      EXPECT_EQ(diff, vector_of_unique<int>({1, 4, 3}));
+    }
+  }
+
+  vector_of_unique<int> vou = {1, 2};
+  EXPECT_EQ(vou.merge_from(vou), 0u);
+  EXPECT_EQ(vou.intersect_with(vou), 0u);
+  EXPECT_EQ(vou.size(), 2u);
+  EXPECT_EQ(vou.subtract(vou), 2u);
+  EXPECT_TRUE(vou.empty());
+  EXPECT_EQ(vou.find_with_hash(1, std::hash<int>{}(1)), vou.cend());
+}
+
+using FlatInt =
+    vector_of_unique<int, std::hash<int>, std::equal_to<int>, std::allocator<int>,
+                     flat_index>;
+
+TEST(VectorOfUniqueTest, FlatIndex_Modifiers) {
+  FlatInt vou;
+  for (int i = 0; i < 10000; ++i) {
+    EXPECT_TRUE(vou.push_back(i));
+    EXPECT_FALSE(vou.push_back(i / 2));
+  }
+  EXPECT_EQ(erase_if(vou, [](int x) { return x % 2 == 0; }), 5000u);
+  EXPECT_TRUE(vou.insert(vou.cbegin() + 1, 0).second);
+  vou.erase(vou.cbegin() + 2);
+  vou.pop_back();
+  ASSERT_EQ(vou.size(), 4999u);
+  EXPECT_EQ(vou.index_of(0), 1u);
+  for (size_t i = 2; i < vou.size(); ++i) {
+    EXPECT_EQ(vou.index_of(vou[i]), i);
+  }
+  EXPECT_EQ(vou.find(3), vou.cend());
+  EXPECT_EQ(vou.find(9999), vou.cend());
+
+  FlatInt copy(vou);
+  EXPECT_EQ(copy, vou);
+  EXPECT_EQ(copy.index_of(5), 2u);
+  FlatInt moved(std::move(copy));
+  EXPECT_EQ(moved.index_of(5), 2u);
+  copy = moved;
+  EXPECT_EQ(copy.index_of(7), 3u);
+  vou.clear();
+  EXPECT_EQ(vou.find(5), vou.cend());
+  EXPECT_TRUE(vou.push_back(5));
+  EXPECT_EQ(vou.index_of(5), 0u);
+}
+
+struct ModFourHash {
+  size_t operator()(int x) const { return static_cast<size_t>(x % 4); }
+};
+
+TEST(VectorOfUniqueTest, FlatIndex_CollidingHashes) {
+  vector_of_unique<int, ModFourHash, std::equal_to<int>, std::allocator<int>,
+                   flat_index>
+      vou;
+  for (int i = 0; i < 500; ++i) {
+    vou.push_back(i);
+  }
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 0; i < 500; i += 3) {
+      erase(vou, i);
+      EXPECT_TRUE(vou.push_back(i));
+    }
+  }
+  ASSERT_EQ(vou.size(), 500u);
+  for (size_t i = 0; i < vou.size(); ++i) {
+    EXPECT_EQ(vou.index_of(vou[i]), i);
+  }
+  EXPECT_EQ(vou.find(500), vou.cend());
+}
+
+TEST(VectorOfUniqueTest, FlatIndex_CapacityAndHashPolicy) {
+  FlatInt vou;
+  EXPECT_EQ(vou.bucket_count(), 0u);
+  EXPECT_LE(vou.max_load_factor(), 0.875f);
+  vou.reserve(1000);
+  auto buckets = vou.bucket_count();
+  EXPECT_GE(static_cast<float>(buckets) * vou.max_load_factor(), 1000.0f);
+  for (int i = 0; i < 1000; ++i) {
+    vou.push_back(i);
+  }
+  EXPECT_EQ(vou.bucket_count(), buckets);
+  EXPECT_LE(vou.load_factor(), vou.max_load_factor());
+  vou.max_load_factor(0.5f);
+  EXPECT_FLOAT_EQ(vou.max_load_factor(), 0.5f);
+  EXPECT_LE(vou.load_factor(), 0.5f);
+  erase_if(vou, [](int x) { return x >= 10; });
+  vou.shrink_to_fit();
+  EXPECT_LT(vou.bucket_count(), buckets);
+  EXPECT_EQ(vou.index_of(9), 9u);
+}
+
+#if __cplusplus >= 201703L
+TEST(VectorOfUniqueTest, FlatIndex_PushAfterReserveDoesNotAllocate) {
+  CountingResource resource;
+  pmr::vector_of_unique<int, std::hash<int>, std::equal_to<int>, flat_index>
+      vou(&resource);
+  vou.reserve(1000);
+  auto allocated = resource.allocated;
+  for (int i = 0; i < 2000; ++i) {
+    vou.push_back(i % 1000);
+  }
+  EXPECT_EQ(vou.size(), 1000u);
+  EXPECT_EQ(resource.allocated, allocated);
+}
+#endif
+
+#if __cplusplus >= 201703L
+TEST(VectorOfUniqueTest, FlatIndex_ChurnDoesNotAllocate) {
+  CountingResource resource;
+  pmr::vector_of_unique<int, std::hash<int>, std::equal_to<int>, flat_index>
+      vou(&resource);
+  vou.reserve(1000);
+  for (int i = 0; i < 1000; ++i) {
+    vou.push_back(i);
+  }
+  auto allocated = resource.allocated;
+  for (int i = 1000; i < 50000; ++i) {
+    EXPECT_EQ(vou.unordered_erase(i - 1000), 1u);
+    EXPECT_TRUE(vou.push_back(i));
+  }
+  EXPECT_EQ(resource.allocated, allocated);
+  ASSERT_EQ(vou.size(), 1000u);
+  for (size_t i = 0; i < vou.size(); ++i) {
+    EXPECT_EQ(vou.index_of(vou[i]), i);
+  }
+  EXPECT_EQ(vou.find(48999), vou.cend());
+}
+#endif
+
+template <class IndexPolicy>
+using CachedInt =
+    vector_of_unique<int, CountingHash, std::equal_to<int>, std::allocator<int>,
+                     cached_hash<IndexPolicy>>;
+
+TEST(VectorOfUniqueTest, CachedHash_ErasureDoesNotRehash) {
+  CachedInt<node_index> vou = {1, 2, 3, 4, 5, 6, 7, 8};
+  CountingHash::calls = 0;
+  vou.pop_back();
+  vou.erase(vou.cbegin() + 1);
+  vou.unordered_erase(vou.cbegin());
+  vou.erase(vou.cend() - 2, vou.cend());
+  EXPECT_EQ(CountingHash::calls, 0);
+  EXPECT_EQ(vou.vector(), std::vector<int>({7, 3, 4}));
+  for (size_t i = 0; i < vou.size(); ++i) {
+    EXPECT_EQ(vou.index_of(vou[i]), i);
+  }
+  EXPECT_FALSE(vou.push_back(3));
+  EXPECT_TRUE(vou.push_back(1));
+}
+
+TEST(VectorOfUniqueTest, CachedHash_InsertWithHash) {
+  CachedInt<flat_index> vou;
+  CountingHash::calls = 0;
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_TRUE(vou.insert_with_hash(i, std::hash<int>{}(i)));
+  }
+  EXPECT_FALSE(vou.insert_with_hash(7, std::hash<int>{}(7)));
+  auto copy = vou;
+  while (!copy.empty()) {
+    copy.pop_back();
+  }
+  EXPECT_EQ(CountingHash::calls, 0);
+  EXPECT_EQ(vou.size(), 100u);
+  vou.insert(vou.cbegin() + 50, 1000);
+  erase_if(vou, [](int x) { return x % 3 == 0; });
+  for (size_t i = 0; i < vou.size(); ++i) {
+    EXPECT_EQ(vou.index_of(vou[i]), i);
+  }
+  CountingHash::calls = 0;
+  vou.erase(vou.cbegin() + 10, vou.cbegin() + 20);
+  vou.erase(vou.cbegin() + 3);
+  EXPECT_EQ(CountingHash::calls, 0);
+  EXPECT_EQ(vou.index_of(1000), 22u);
+}
+
+TEST(VectorOfUniqueTest, ExtractAndInsertNodes) {
+  vector_of_unique<std::string> src = {"a", "b", "c", "d"};
+  vector_of_unique<std::string> dst = {"c"};
+  auto nh = src.extract(src.cbegin() + 1);
+  ASSERT_FALSE(nh.empty());
+  EXPECT_EQ(nh.value(), "b");
+  EXPECT_EQ(nh.hash(), std::hash<std::string>{}("b"));
+  EXPECT_EQ(src, vector_of_unique<std::string>({"a", "c", "d"}));
+  EXPECT_EQ(src.index_of("d"), 2u);
+
+  auto result = dst.insert(std::move(nh));
+  EXPECT_TRUE(result.inserted);
+  EXPECT_EQ(*result.position, "b");
+  EXPECT_TRUE(result.node.empty());
+  EXPECT_TRUE(nh.empty());
+  EXPECT_EQ(dst.index_of("b"), 1u);
+
+  // A duplicate is handed back in the result.
+  auto dup = dst.insert(src.extract("c"));
+  EXPECT_FALSE(dup.inserted);
+  EXPECT_EQ(dup.position, dst.cbegin());
+  ASSERT_FALSE(dup.node.empty());
+  EXPECT_EQ(dup.node.value(), "c");
+  EXPECT_TRUE(src.insert(std::move(dup.node)).inserted);
+  EXPECT_EQ(src, vector_of_unique<std::string>({"a", "d", "c"}));
+  EXPECT_EQ(src.index_of("c"), 2u);
+
+  EXPECT_TRUE(src.extract("z").empty());
+  EXPECT_FALSE(dst.insert(vector_of_unique<std::string>::node_type()).inserted);
+}
+
+TEST(VectorOfUniqueTest, CachedHash_MoveNodesWithoutHashing) {
+  CachedInt<flat_index> src = {1, 2, 3, 4, 5, 6};
+  CachedInt<flat_index> dst;
+  dst.reserve(6);
+  CountingHash::calls = 0;
+  for (auto pos : {4, 0, 2}) {
+    EXPECT_TRUE(dst.insert(src.extract(src.cbegin() + pos)).inserted);
+  }
+  EXPECT_EQ(CountingHash::calls, 0);
+  EXPECT_EQ(src.vector(), std::vector<int>({2, 3, 6}));
+  EXPECT_EQ(dst.vector(), std::vector<int>({5, 1, 4}));
+  for (int v : {2, 3, 6}) {
+    EXPECT_EQ(src[src.index_of(v)], v);
+  }
+  for (int v : {5, 1, 4}) {
+    EXPECT_EQ(dst[dst.index_of(v)], v);
+  }
+}
+
+TEST(VectorOfUniqueTest, AdoptAndReleaseWithoutCopying) {
+  std::vector<std::string> input = {"c", "a", "b"};
+  const auto* data = input.data();
+  auto vou = vector_of_unique<std::string>::adopt_unique(std::move(input));
+  EXPECT_EQ(vou.vector().data(), data);
+  EXPECT_EQ(vou.index_of("b"), 2u);
+  EXPECT_FALSE(vou.push_back("a"));
+  EXPECT_TRUE(vou.push_back("d"));
+
+  auto released = std::move(vou).release();
+  EXPECT_EQ(released, std::vector<std::string>({"c", "a", "b", "d"}));
+  EXPECT_TRUE(vou.empty());
+  EXPECT_EQ(vou.find("a"), vou.cend());
+  EXPECT_TRUE(vou.push_back("a"));
+
+  EXPECT_DEBUG_DEATH(vector_of_unique<int>::adopt_unique({1, 2, 1}),
+                     "duplicate");
+}
+
+using BloomInt =
+    vector_of_unique<int, std::hash<int>, std::equal_to<int>, std::allocator<int>,
+                     bloom_filter<flat_index, 12>>;
+
+TEST(VectorOfUniqueTest, BloomFilter_SkipsProbesForAbsentKeys) {
+  BloomInt vou;
+  for (int i = 0; i < 5000; ++i) {
+    EXPECT_TRUE(vou.push_back(i * 3));
+    EXPECT_FALSE(vou.push_back(i * 3));
+  }
+  auto before = vou.prefilter_stats();
+  for (int i = 0; i < 5000; ++i) {
+    EXPECT_EQ(vou.index_of(i * 3), static_cast<size_t>(i));
+    EXPECT_EQ(vou.find(i * 3 + 1), vou.cend());
+  }
+  auto after = vou.prefilter_stats();
+  EXPECT_EQ(after.lookups - before.lookups, 10000u);
+  // Present keys always pass; nearly every absent key is filtered.
+  EXPECT_GT(after.filtered - before.filtered, 4900u);
+
+  // Erased keys are found absent, and the filter survives copies, swaps
+  // and clear.
+  vou.erase(vou.cbegin(), vou.cbegin() + 2500);
+  EXPECT_EQ(vou.find(0), vou.cend());
+  BloomInt copy(vou);
+  BloomInt other = {1, 2};
+  copy.swap(other);
+  EXPECT_EQ(copy.index_of(2), 1u);
+  EXPECT_EQ(other.index_of(7500), 0u);
+  other.clear();
+  EXPECT_EQ(other.find(7500), other.cend());
+  EXPECT_TRUE(other.push_back(7500));
+  EXPECT_EQ(other.index_of(7500), 0u);
+}
+
+TEST(VectorOfUniqueTest, BloomFilter_MovedFromIsReusable) {
+  vector_of_unique<int, std::hash<int>, std::equal_to<int>, std::allocator<int>,
+                   bloom_filter<>>
+      a = {1, 2, 3};
+  auto b(std::move(a));
+  EXPECT_EQ(b.index_of(3), 2u);
+  EXPECT_EQ(a.find(1), a.cend());
+  EXPECT_TRUE(a.push_back(1));
+  EXPECT_EQ(a.index_of(1), 0u);
+
+  BloomInt c = {4, 5};
+  BloomInt d;
+  d = std::move(c);
+  EXPECT_EQ(d.index_of(5), 1u);
+  EXPECT_EQ(c.find(4), c.cend());
+  for (int i = 0; i < 200; ++i) {
+    EXPECT_TRUE(c.push_back(i));
+  }
+  EXPECT_EQ(c.index_of(199), 199u);
+  EXPECT_EQ(c.find(200), c.cend());
+}
+
+TEST(VectorOfUniqueTest, BatchedLookups) {
+  FlatInt vou;
+  for (int i = 0; i < 1000; ++i) {
+    vou.push_back(i * 2);
+  }
+  // 150 keys span three bitmap words, the last one partly.
+  std::vector<int> keys;
+  for (int i = 0; i < 150; ++i) {
+    keys.push_back(i * 7);
+  }
+  std::vector<std::uint64_t> bits(3, ~std::uint64_t{0});
+  vou.contains_batch(keys.begin(), keys.end(), bits.data());
+  std::vector<FlatInt::const_iterator> found;
+  vou.find_batch(keys.begin(), keys.end(), std::back_inserter(found));
+  ASSERT_EQ(found.size(), keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    bool present = keys[i] % 2 == 0;
+    EXPECT_EQ((bits[i / 64] >> (i % 64)) & 1, present ? 1u : 0u) << i;
+    EXPECT_EQ(found[i], vou.find(keys[i]));
+  }
+  EXPECT_EQ(bits[2] >> 22, 0u);
+
+  vector_of_unique<std::string> empty;
+  std::vector<std::string> words = {"a", "b"};
+  bits[0] = 3;
+  empty.contains_batch(words.begin(), words.end(), bits.data());
+  EXPECT_EQ(bits[0], 0u);
+}